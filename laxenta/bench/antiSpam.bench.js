@@ -0,0 +1,41 @@
+// Micro-benchmark for the anti-spam sliding window (src/utils/spamTracker.js).
+// Usage: node --expose-gc bench/antiSpam.bench.js [users] [messages]
+const { SpamTracker } = require('../src/utils/spamTracker');
+
+const USERS = Number(process.argv[2]) || 10000;
+const MESSAGES = Number(process.argv[3]) || 1000000;
+const GUILDS = 50;
+const thresholds = { limit: 5, timeFrame: 10000 };
+
+const gc = global.gc || (() => {});
+const heapUsed = () => {
+    gc();
+    return process.memoryUsage().heapUsed;
+};
+
+const tracker = new SpamTracker({ maxLimit: 20, sweepInterval: 0 });
+const baseline = heapUsed();
+
+// Messages spread over a simulated hour so most users stay under the limit.
+const start = Date.now();
+let now = start;
+let flagged = 0;
+
+const t0 = process.hrtime.bigint();
+for (let i = 0; i < MESSAGES; i++) {
+    const user = (i * 2654435761) % USERS;
+    now += 3600000 / MESSAGES;
+    if (tracker.record(`g${user % GUILDS}`, `u${user}`, `c${i % 20}`, `m${i}`, thresholds, now)) flagged++;
+}
+const elapsedNs = Number(process.hrtime.bigint() - t0);
+
+const tracked = heapUsed() - baseline;
+const evicted = tracker.sweep(now + 120000);
+
+console.log(`users tracked:     ${tracker.size + evicted}`);
+console.log(`messages:          ${MESSAGES}`);
+console.log(`per-message cost:  ${(elapsedNs / MESSAGES).toFixed(1)} ns`);
+console.log(`throughput:        ${Math.round(MESSAGES / (elapsedNs / 1e9)).toLocaleString()} msg/s`);
+console.log(`flagged:           ${flagged}`);
+console.log(`heap for windows:  ${(tracked / 1024 / 1024).toFixed(2)} MiB (${Math.round(tracked / USERS)} B/user)${global.gc ? '' : ' (run with --expose-gc for stable numbers)'}`);
+console.log(`evicted when idle: ${evicted}, remaining ${tracker.size}`);
@@ -0,0 +1,108 @@
+// Memory and startup cost of hosting user bots: BotHost (worker-thread pool)
+// versus the old one-process-per-bot model.
+// Usage: node bench/botHost.bench.js [counts=1,10,100] [--spawn-max=10] [--workers=2]
+//
+// Bots are built exactly as in production (client with trimmed caches, history
+// store, shared agents) but skip the gateway login, so no tokens are needed and
+// the numbers isolate the runtime's own cost.
+const { fork } = require('child_process');
+
+const args = process.argv.slice(2);
+const option = (name, fallback) => {
+    const arg = args.find(a => a.startsWith(`--${name}=`));
+    return arg ? arg.split('=')[1] : fallback;
+};
+
+const fakeConfig = (i) => ({
+    id: `bench${i}`,
+    name: `Bench${i}`,
+    token: 'bench-token',
+    model: 'bench-model',
+    instruction: 'You are a benchmark.',
+    settings: {
+        temperature: 0.9, presence_penalty: 0.6, frequency_penalty: 0.7, limit: 10, maxLength: 4000,
+        typingInterval: 5000, requestTimeout: 30000, maxRetries: 3, cooldown: 3000
+    },
+    presence: { status: 'online', activity: 'benchmarks', activityType: 'PLAYING' }
+});
+
+const mb = (bytes) => `${(bytes / 1024 / 1024).toFixed(1)} MiB`;
+
+// ---- Child roles -----------------------------------------------------------
+
+// One bot per process, the way BotManager used to run them.
+async function runSingleBot() {
+    const startedAt = Date.now();
+    const { HostedBot } = require('../src/servers/botRuntime');
+    const bot = new HostedBot(fakeConfig(process.pid), { dryRun: true });
+    await bot.start();
+    process.send({ rss: process.memoryUsage().rss, startupMs: Date.now() - startedAt });
+}
+
+// N bots inside one BotHost, measured from a fresh process.
+async function runHost(count, workers) {
+    const baseline = process.memoryUsage().rss;
+    const startedAt = Date.now();
+    const { BotHost } = require('../src/servers/botHost');
+    const host = new BotHost({ workers, dryRun: true });
+    await Promise.all(Array.from({ length: count }, (_, i) => host.start(fakeConfig(i))));
+    const startupMs = Date.now() - startedAt;
+
+    const stats = await host.getStats();
+    process.send({ rss: stats.rss, baseline, startupMs, workers: stats.workers.length });
+    await host.close();
+}
+
+// ---- Driver ----------------------------------------------------------------
+
+function child(role, ...extra) {
+    return new Promise((resolve, reject) => {
+        const proc = fork(__filename, ['--role=' + role, ...extra], { stdio: ['ignore', 'ignore', 'inherit', 'ipc'] });
+        proc.once('message', (result) => {
+            resolve(result);
+            setTimeout(() => proc.kill(), 100);
+        });
+        proc.once('error', reject);
+        proc.once('exit', (code) => code && reject(new Error(`${role} child exited with ${code}`)));
+    });
+}
+
+async function measureSpawn(count) {
+    const startedAt = Date.now();
+    const results = await Promise.all(Array.from({ length: count }, () => child('single')));
+    return {
+        startupMs: Date.now() - startedAt,
+        rss: results.reduce((sum, r) => sum + r.rss, 0)
+    };
+}
+
+async function main() {
+    const counts = (args.find(a => /^\d/.test(a)) || '1,10,100').split(',').map(Number);
+    const spawnMax = Number(option('spawn-max', 10));
+    const workers = Number(option('workers', 2));
+
+    console.log(`BotHost with ${workers} worker thread(s) vs one process per bot (dry run, no gateway login)\n`);
+    for (const count of counts) {
+        const host = await child('host', `--count=${count}`, `--workers=${workers}`);
+        console.log(`${String(count).padStart(3)} bot(s)  host:  startup ${host.startupMs} ms, RSS ${mb(host.rss)} (${mb((host.rss - host.baseline) / count)}/bot over an idle process)`);
+
+        if (count <= spawnMax) {
+            const spawned = await measureSpawn(count);
+            console.log(`${' '.repeat(10)}spawn: startup ${spawned.startupMs} ms, RSS ${mb(spawned.rss)} (${mb(spawned.rss / count)}/bot)`);
+        } else {
+            console.log(`${' '.repeat(10)}spawn: skipped (raise --spawn-max to measure)`);
+        }
+    }
+}
+
+const role = option('role', null);
+if (role === 'single') {
+    runSingleBot();
+} else if (role === 'host') {
+    runHost(Number(option('count', 1)), Number(option('workers', 2)));
+} else {
+    main().catch((error) => {
+        console.error(error);
+        process.exit(1);
+    });
+}
@@ -0,0 +1,62 @@
+// Load test for the economy ledger: N concurrent bettors against a local MongoDB.
+// Usage: node bench/economy.load.js [bettors] [betsPerBettor] [--write-behind]
+// Uses MONGO_URI (default mongodb://127.0.0.1:27017) and a throwaway database.
+process.env.MONGO_URI = process.env.MONGO_URI || 'mongodb://127.0.0.1:27017';
+process.env.ECONOMY_DB = process.env.ECONOMY_DB || 'economyLoadTest';
+
+const mongoose = require('mongoose');
+const economy = require('../src/utils/economyUtil');
+
+const BETTORS = Number(process.argv[2]) || 200;
+const BETS = Number(process.argv[3]) || 50;
+const WRITE_BEHIND = process.argv.includes('--write-behind');
+const STAKE = 10000;
+
+function percentile(sorted, p) {
+  return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+}
+
+async function bettor(userId, latencies) {
+  let rejected = 0;
+  for (let i = 0; i < BETS; i++) {
+    const payout = Math.random() < 0.5 ? STAKE * 2 : 0;
+    const start = process.hrtime.bigint();
+    const { ok } = await economy.settleBet(userId, STAKE, payout);
+    latencies.push(Number(process.hrtime.bigint() - start) / 1e6);
+    if (!ok) rejected++;
+  }
+  return rejected;
+}
+
+(async () => {
+  const users = await economy.connectDB();
+  await users.deleteMany({});
+  if (WRITE_BEHIND) economy.enableWriteBehind({ interval: 500 });
+
+  const latencies = [];
+  const start = Date.now();
+  const rejected = await Promise.all(
+    Array.from({ length: BETTORS }, (_, i) => bettor(`loadtest-${i}`, latencies))
+  );
+  const elapsed = Date.now() - start;
+  await economy.disableWriteBehind();
+
+  latencies.sort((a, b) => a - b);
+  const negative = await users.countDocuments({ balance: { $lt: 0 } });
+  const top = await economy.getLeaderboard(3);
+
+  console.log(`mode:            ${WRITE_BEHIND ? 'write-behind' : 'direct'}`);
+  console.log(`bets:            ${latencies.length} (${BETTORS} bettors x ${BETS})`);
+  console.log(`throughput:      ${Math.round(latencies.length / (elapsed / 1000))} bets/s`);
+  console.log(`latency p50/p99: ${percentile(latencies, 0.5).toFixed(2)} / ${percentile(latencies, 0.99).toFixed(2)} ms`);
+  console.log(`rejected bets:   ${rejected.reduce((a, b) => a + b, 0)}`);
+  console.log(`overdrawn users: ${negative}`);
+  console.log(`leaderboard:     ${top.map(u => `${u.userId}=${u.balance}`).join(', ')}`);
+
+  await users.drop();
+  await mongoose.disconnect();
+})().catch(async (err) => {
+  console.error(err);
+  await mongoose.disconnect().catch(() => {});
+  process.exit(1);
+});
@@ -6,6 +6,7 @@ const path = require('path');
 const fs = require('fs');
 const { logger } = require('./src/utils/logger');
 const WebServer = require('./src/servers/webServer');
+const { setupBirthdayDispatcher } = require('./src/utils/birthdayDispatcher');
 
 // Validate the environment variable
 if (!process.env.DISCORD_TOKEN) {
@@ -73,6 +74,9 @@ client.once('ready', async () => {
         // Initialize web server after client is ready
         client.webServer = new WebServer(client);
         logger.info('Web server initialized');
+
+        // Hourly birthday greetings (deduplicated per user and year)
+        setupBirthdayDispatcher(client);
     } catch (error) {
         logger.error('Error during initialization:', error.message);
     }
@@ -14,9 +14,9 @@ module.exports = {
   description: 'Flip a coin and double your money if you win (Max bet: 500k)',
   async execute(message, args) {
     const userId = message.author.id;
-    let balance = await economy.getBalance(userId);
 
     if (!args[0]) {
+      const balance = await economy.getBalance(userId);
       return message.channel.send(`Provide a bet amount. Balance: ⏣ ${balance}`);
     }
 
@@ -24,23 +24,24 @@ module.exports = {
     let bet;
 
     if (betArg === "max" || betArg === "all") {
-      bet = Math.min(balance, MAX_BET);
+      bet = Math.min(await economy.getBalance(userId), MAX_BET);
     } else {
       bet = parseBetArg(betArg);
     }
 
-    if (isNaN(bet) || bet <= 0 || bet > MAX_BET || bet > balance) {
+    if (isNaN(bet) || bet <= 0 || bet > MAX_BET) {
+      const balance = await economy.getBalance(userId);
       return message.channel.send(`Invalid bet. Balance: ⏣ ${balance}, Max bet: ⏣ ${MAX_BET}`);
     }
 
-    await economy.updateBalance(userId, -bet);
-
     const isWin = Math.random() < 0.5;
     let winnings = isWin ? bet * 2 : 0;
-    if (isWin) {
-      await economy.updateBalance(userId, winnings);
+
+    // Stake check, deduction and payout in a single atomic update.
+    const { ok, balance } = await economy.settleBet(userId, bet, winnings);
+    if (!ok) {
+      return message.channel.send(`Invalid bet. Balance: ⏣ ${balance}, Max bet: ⏣ ${MAX_BET}`);
     }
-    balance = await economy.getBalance(userId);
     const net = winnings - bet;
 
     let resultMessage = `🪙 Coin Flip Results 🪙\n\n`;
@@ -50,9 +50,9 @@ module.exports = {
   description: 'Play the slots machine! Usage: `!slots <bet amount | max | all>`',
   async execute(message, args) {
     const userId = message.author.id;
-    let balance = await economy.getBalance(userId);
 
     if (!args[0]) {
+      const balance = await economy.getBalance(userId);
       return message.channel.send(`Please provide a bet amount. Your balance: ⏣ ${balance}`);
     }
 
@@ -61,27 +61,22 @@ module.exports = {
 
     // Check for max/all keywords.
     if (betArg === "max" || betArg === "all") {
-      bet = Math.min(balance, MAX_BET);
+      bet = Math.min(await economy.getBalance(userId), MAX_BET);
     } else {
       // Parse bet removing commas and any non-digit characters.
       bet = parseBetArg(betArg);
     }
 
-    if (isNaN(bet) || bet <= 0 || bet > MAX_BET || bet > balance) {
+    if (isNaN(bet) || bet <= 0 || bet > MAX_BET) {
+      const balance = await economy.getBalance(userId);
       return message.channel.send(
         `Invalid bet! Your balance: ⏣ ${balance}, Max bet: ⏣ ${MAX_BET}`
       );
     }
 
-    // Deduct the bet from the user's balance.
-    await economy.updateBalance(userId, -bet);
-
     // Spin the reels.
     const reels = [pickSymbol(), pickSymbol(), pickSymbol()];
 
-    // Animate the roll.
-    const rollMsg = await animateRoll(message, reels, 1200);
-
     // Determine win type and calculate multiplier.
     let winType = null, winMultiplier = 0;
     if (reels[0].emoji === reels[1].emoji && reels[1].emoji === reels[2].emoji) {
@@ -98,10 +93,17 @@ module.exports = {
     }
 
     let winnings = winMultiplier > 0 ? Math.floor(bet * winMultiplier) : 0;
-    if (winnings > 0) {
-      await economy.updateBalance(userId, winnings);
+
+    // Stake check, deduction and payout in a single atomic update.
+    const { ok, balance } = await economy.settleBet(userId, bet, winnings);
+    if (!ok) {
+      return message.channel.send(
+        `Invalid bet! Your balance: ⏣ ${balance}, Max bet: ⏣ ${MAX_BET}`
+      );
     }
-    balance = await economy.getBalance(userId);
+
+    // Animate the roll.
+    const rollMsg = await animateRoll(message, reels, 1200);
     const net = winnings - bet;
 
     // Build the result message.
@@ -344,9 +344,8 @@ module.exports = {
       if (inventory.fates[fateType] < 1) {
         const missing = 1 - inventory.fates[fateType];
         const cost = missing * 30000;
-        const balance = await economy.getBalance(userId);
-        if (balance >= cost) {
-          await economy.updateBalance(userId, -cost);
+        const { ok } = await economy.debit(userId, cost);
+        if (ok) {
           inventory.fates[fateType] += missing;
           await inventory.save();
         } else {
@@ -410,9 +409,8 @@ module.exports = {
       if (inventory.fates[fateType] < 10) {
         const missing = 10 - inventory.fates[fateType];
         const cost = missing * 30000;
-        const balance = await economy.getBalance(userId);
-        if (balance >= cost) {
-          await economy.updateBalance(userId, -cost);
+        const { ok } = await economy.debit(userId, cost);
+        if (ok) {
           inventory.fates[fateType] += missing;
           await inventory.save();
         } else {
@@ -469,11 +467,10 @@ module.exports = {
       const currentBanner = inventory.currentBanner;
       const fateData = getFateTypeAndEmoji(currentBanner);
       const fateType = (currentBanner === 'standard') ? 'acquaint' : 'intertwined';
-      const balance = await economy.getBalance(userId);
-      if (balance < 30000) {
+      const { ok } = await economy.debit(userId, 30000);
+      if (!ok) {
         return interaction.reply({ content: "You don't have enough coins to buy a Fate!", ephemeral: true });
       }
-      await economy.updateBalance(userId, -30000);
       inventory.fates[fateType] += 1;
       await inventory.save();
       return interaction.reply({ 
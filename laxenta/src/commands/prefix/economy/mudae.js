@@ -141,12 +141,11 @@ function getRandomElement(array) {
 
 async function handleMarriageConfirmation(interaction, marriage, rollId, cost) {
   try {
-    const currentBalance = await economy.getBalance(interaction.user.id);
-    if (currentBalance < cost) {
+    const { ok, balance: newBalance } = await economy.debit(interaction.user.id, cost);
+    if (!ok) {
       throw new Error(`Insufficient funds! You need ⏣ **${cost.toLocaleString()}**. Use \`!slots\` or \`!eco\` to earn more coins.`);
     }
 
-    const newBalance = await economy.updateBalance(interaction.user.id, -cost);
     let record = await Marriage.findOne({ userId: interaction.user.id });
     
     if (!record) {
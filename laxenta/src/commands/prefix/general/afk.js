@@ -9,14 +9,8 @@ mongoose.connect(mongoUri)
   .then(() => console.log("Connected to MongoDB for AFK functionality."))
   .catch((err) => console.error("MongoDB connection error:", err));
 
-// AFK Schema (auto-cleanup after 24 hours)
-const afkSchema = new mongoose.Schema({
-  guildId: String,
-  userId: String,
-  reason: String,
-  timestamp: { type: Date, default: Date.now, expires: 86400 } // 86400 seconds = 24 hours
-});
-const AFK = mongoose.models.AFK || mongoose.model('AFK', afkSchema);
+// AFK state goes through the guild cache so messageCreate stays coherent
+const { getAfk, setAfk } = require('../../../utils/guildCache');
 
 module.exports = {
   name: 'afk',
@@ -28,7 +22,7 @@ module.exports = {
       const guildId = message.guild.id;
 
       // Check if the user is already AFK
-      const existingAfk = await AFK.findOne({ guildId, userId });
+      const existingAfk = await getAfk(guildId, userId);
       if (existingAfk) {
         return message.reply({
           embeds: [
@@ -40,7 +34,7 @@ module.exports = {
       }
 
       // Set the new AFK status
-      await AFK.create({ guildId, userId, reason });
+      await setAfk(guildId, userId, reason);
 
       // Update the user's nickname to include [AFK]
       const member = message.guild.members.cache.get(userId);
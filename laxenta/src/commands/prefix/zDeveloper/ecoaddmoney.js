@@ -40,11 +40,11 @@ module.exports = {
       newBalance = await economy.updateBalance(targetUser.id, amount);
       message.channel.send(`✅ **Added ⏣${amount.toLocaleString()}** coins to ${targetUser.username}.\n💰 New Balance: **${newBalance.toLocaleString()}**`);
     } else if (action === 'withdraw') {
-      const currentBalance = await economy.getBalance(targetUser.id);
-      if (amount > currentBalance) {
+      const result = await economy.debit(targetUser.id, amount);
+      if (!result.ok) {
         return message.channel.send(`❌ ${targetUser.username} does not have enough funds to withdraw ⏣**${amount.toLocaleString()}**.`);
       }
-      newBalance = await economy.updateBalance(targetUser.id, -amount);
+      newBalance = result.balance;
       message.channel.send(`✅ **Withdrew ⏣${amount.toLocaleString()}** coins from ${targetUser.username}.\n💰 New Balance: ⏣**${newBalance.toLocaleString()}**`);
     }
   },
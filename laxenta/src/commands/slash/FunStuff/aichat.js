@@ -1,37 +1,9 @@
 const { SlashCommandBuilder, MessageFlags } = require('discord.js');
-const fs = require('fs');
 const path = require('path');
+const { openStore } = require('../../../utils/jsonStore');
 
-// Define the JSON file path for storing active AI chat channels
-const filePath = path.join(__dirname, '../../../data/activeChannels.json');
-
-// Ensure the directory exists
-const directory = path.dirname(filePath);
-if (!fs.existsSync(directory)) {
-  fs.mkdirSync(directory, { recursive: true });
-}
-
-// Load existing active channels from file
-function loadActiveChannels() {
-  if (fs.existsSync(filePath)) {
-    try {
-      return JSON.parse(fs.readFileSync(filePath, 'utf8'));
-    } catch (err) {
-      console.error('❌ Error reading activeChannels JSON file:', err);
-      return {};
-    }
-  }
-  return {};
-}
-
-// Save active channels to file
-function saveActiveChannels(data) {
-  try {
-    fs.writeFileSync(filePath, JSON.stringify(data, null, 2));
-  } catch (err) {
-    console.error('❌ Error writing activeChannels JSON file:', err);
-  }
-}
+// Active AI chat channels, shared in memory with the aiChatChannel event
+const activeChannels = openStore(path.join(__dirname, '../../../data/activeChannels.json'), { pretty: true });
 
 module.exports = {
   data: new SlashCommandBuilder()
@@ -47,28 +19,9 @@ module.exports = {
     const guildId = interaction.guild?.id || "DM"; // Handle DMs properly
     const channelId = interaction.channel.id;
 
-    // Load and update the file data
-    let activeChannels = loadActiveChannels();
-
-    // Ensure the guild exists in the data structure
-    if (!activeChannels[guildId]) {
-      activeChannels[guildId] = {};
-    }
-
-    const wasActive = activeChannels[guildId][channelId] || false;
-    activeChannels[guildId][channelId] = activate;
-    saveActiveChannels(activeChannels);
-
-    // Update the in-memory map on the client
-    if (!interaction.client.activeChannels) {
-      interaction.client.activeChannels = new Map();
-    }
-
-    // Store with proper guild-channel structure in memory
-    if (!interaction.client.activeChannels.has(guildId)) {
-      interaction.client.activeChannels.set(guildId, new Map());
-    }
-    interaction.client.activeChannels.get(guildId).set(channelId, activate);
+    // Update the shared store (persisted in the background)
+    const wasActive = activeChannels.get(guildId)?.[channelId] || false;
+    activeChannels.update(guildId, (channels = {}) => ({ ...channels, [channelId]: activate }));
 
     await interaction.reply({
       content: `Goofy Navia ${activate ? 'activated' : 'deactivated'} for this channel.`,
@@ -10,7 +10,6 @@ const {
   StringSelectMenuOptionBuilder
 } = require('discord.js');
 const mongoose = require('mongoose');
-const cron = require('node-cron');
 
 // MongoDB Connection
 async function connectDatabase() {
@@ -27,24 +26,12 @@ async function connectDatabase() {
   }
 }
 
-// Schema Definition
-const birthdaySchema = new mongoose.Schema({
-  userId: { type: String, required: true, unique: true },
-  username: { type: String, required: true },
-  day: { type: Number, required: true },
-  month: { type: Number, required: true },
-  year: { type: Number },
-  createdAt: { type: Date, default: Date.now },
-  wishList: [{ userId: String, username: String, timestamp: Date }],
-  followers: [{ userId: String, username: String, timestamp: Date }]
-});
-
-// Optimize queries with indexes
-birthdaySchema.index({ month: 1, day: 1 });
-birthdaySchema.index({ userId: 1 });
-birthdaySchema.index({ username: 'text' });
-
-const Birthday = mongoose.models.Birthday || mongoose.model('Birthday', birthdaySchema);
+const { Birthday } = require('../../../models/Birthday');
+const {
+  greetIfBirthday,
+  buildBirthdayEmbed,
+  isValidTimezone
+} = require('../../../utils/birthdayDispatcher');
 
 // Utility functions
 const months = [
@@ -143,14 +130,7 @@ async function sendBirthdayDM(client, userId, username) {
     const user = await client.users.fetch(userId);
     if (!user) return false;
     
-    const embed = new EmbedBuilder()
-      .setColor('#FF69B4')
-      .setTitle('🎂 Happy Birthday!')
-      .setDescription(`Hey ${username}, it's your birthday today! Enjoy your day and some cake! 🍰`)
-      .setImage('https://i.pinimg.com/originals/57/e3/c8/57e3c8a764413d509584fc526825b980.gif')
-      .setTimestamp();
-    
-    await user.send({ embeds: [embed] });
+    await user.send({ embeds: [buildBirthdayEmbed(username)] });
     console.log(`Birthday DM sent to ${username} (${userId})`);
     return true;
   } catch (err) {
@@ -159,69 +139,6 @@ async function sendBirthdayDM(client, userId, username) {
   }
 }
 
-async function sendFollowNotificationDM(client, followerUserId, birthdayUser) {
-  try {
-    const follower = await client.users.fetch(followerUserId);
-    if (!follower) return false;
-    
-    let user = null;
-    try {
-      user = await client.users.fetch(birthdayUser.userId);
-    } catch (e) {
-      // User not found, continue without avatar
-    }
-    
-    const embed = new EmbedBuilder()
-      .setColor('#00FFFF')
-      .setTitle('🔔 Birthday Notification')
-      .setDescription(`**${birthdayUser.username}'s** birthday is today!`)
-      .setThumbnail(user ? user.displayAvatarURL({ dynamic: true }) : null)
-      .addFields(
-        { name: 'Birth Date', value: formatDate(birthdayUser.day, birthdayUser.month, birthdayUser.year), inline: true },
-        { name: 'Birthday User', value: `<@${birthdayUser.userId}>`, inline: true }
-      )
-      .setTimestamp();
-    
-    await follower.send({ embeds: [embed] });
-    console.log(`Follow notification DM sent to ${followerUserId}`);
-    return true;
-  } catch (err) {
-    console.error(`Error sending follow notification DM to ${followerUserId}:`, err);
-    return false;
-  }
-}
-
-// Birthday checker (runs every hour)
-function setupBirthdayChecker(client) {
-  cron.schedule('0 * * * *', async () => {
-    try {
-      const now = new Date();
-      const currentMonth = now.getMonth() + 1;
-      const currentDay = now.getDate();
-      console.log(`🎂 Birthday check running for ${currentMonth}-${currentDay}`);
-      
-      const todaysBirthdays = await Birthday.find({ month: currentMonth, day: currentDay });
-      console.log(`Found ${todaysBirthdays.length} birthdays today`);
-      
-      for (const birthday of todaysBirthdays) {
-        // Send DM to birthday person
-        await sendBirthdayDM(client, birthday.userId, birthday.username);
-        
-        // Notify followers
-        if (birthday.followers && birthday.followers.length > 0) {
-          console.log(`Notifying ${birthday.followers.length} followers for ${birthday.username}`);
-          for (const follower of birthday.followers) {
-            await sendFollowNotificationDM(client, follower.userId, birthday);
-          }
-        }
-      }
-    } catch (error) {
-      console.error('Birthday checker error:', error);
-    }
-  });
-  console.log('🕒 Birthday checker scheduled (every hour)!');
-}
-
 // Pagination helpers
 function createPaginationRow(currentPage, totalPages) {
   return new ActionRowBuilder()
@@ -363,6 +280,14 @@ async function setBirthday(interaction) {
     const day = interaction.options.getInteger('day');
     const month = interaction.options.getInteger('month');
     const year = interaction.options.getInteger('year') || null;
+    const timezone = interaction.options.getString('timezone') || undefined;
+    
+    if (timezone && !isValidTimezone(timezone)) {
+      return interaction.reply({
+        embeds: [createErrorEmbed('Invalid Timezone', `\`${timezone}\` is not a valid timezone. Use a name like \`Europe/London\` or \`Asia/Kolkata\`.`)],
+        ephemeral: true
+      });
+    }
     
     if (!validateDate(day, month, year)) {
       return interaction.reply({
@@ -373,14 +298,15 @@ async function setBirthday(interaction) {
     
     const user = await interaction.client.users.fetch(interaction.user.id);
     
-    await Birthday.findOneAndUpdate(
+    const birthday = await Birthday.findOneAndUpdate(
       { userId: interaction.user.id },
       { 
         userId: interaction.user.id, 
         username: interaction.user.username, 
         day, 
         month, 
-        year 
+        year,
+        ...(timezone && { timezone })
       },
       { upsert: true, new: true }
     );
@@ -402,10 +328,8 @@ async function setBirthday(interaction) {
     
     await interaction.reply({ embeds: [embed] });
     
-    // If today is the birthday, send DM immediately
-    if (isBirthdayToday(day, month)) {
-      await sendBirthdayDM(interaction.client, interaction.user.id, interaction.user.username);
-    }
+    // If today is the birthday, send DM immediately (only once per year)
+    await greetIfBirthday(interaction.client, birthday);
   } catch (error) {
     console.error('Error in setBirthday:', error);
     await interaction.reply({
@@ -1233,7 +1157,11 @@ const birthdayCommandData = new SlashCommandBuilder()
           .setDescription('Year of your birth (optional)')
           .setRequired(false)
           .setMinValue(1900)
-          .setMaxValue(new Date().getFullYear())))
+          .setMaxValue(new Date().getFullYear()))
+      .addStringOption(option =>
+        option.setName('timezone')
+          .setDescription('Your timezone, e.g. Europe/London (optional)')
+          .setRequired(false)))
   .addSubcommand(subcommand =>
     subcommand
       .setName('lookup')
@@ -1445,6 +1373,5 @@ async function lookupBirthday(interaction, directUserId = null) {
 module.exports = {
   data: birthdayCommandData,
   execute,
-  connectDatabase,
-  setupBirthdayChecker
+  connectDatabase
 };
\ No newline at end of file
@@ -482,9 +482,10 @@ async function handleShop(interaction, userId, username) {
     const [fateType, countStr] = i.values[0].split('_');
     const count = parseInt(countStr);
     const price = getFatePriceByType(fateType) * count;
-    const currentBalance = await economy.getBalance(userId);
+    // Deduct coins first; the debit fails instead of overdrawing
+    const { ok, balance: currentBalance } = await economy.debit(userId, price);
     
-    if (currentBalance < price) {
+    if (!ok) {
       await i.update({ 
         content: `❌ You don't have enough coins! You need ${price.toLocaleString()} coins but only have ${currentBalance.toLocaleString()}.`,
         embeds: [shopEmbed], 
@@ -498,9 +499,6 @@ async function handleShop(interaction, userId, username) {
     userInv.fates[fateType] += count;
     await userInv.save();
     
-    // Deduct coins
-    await economy.addBalance(userId, -price);
-    
     await i.update({ 
       content: `✅ Successfully purchased ${count}x ${fateType === 'acquaint' ? acquaintFateEmoji : intertwinedFateEmoji} ${fateType === 'acquaint' ? 'Acquaint' : 'Intertwined'} ${count > 1 ? 'Fates' : 'Fate'} for ${price.toLocaleString()} coins!`,
       embeds: [shopEmbed], 
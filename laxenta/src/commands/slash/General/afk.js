@@ -14,14 +14,8 @@ mongoose.connect(mongoUri)
   .then(() => console.log("Connected to MongoDB for AFK functionality."))
   .catch((err) => console.error("MongoDB connection error:", err));
 
-// AFK Schema with auto-cleanup after 24h (86400 seconds)
-const afkSchema = new mongoose.Schema({
-  guildId: String,
-  userId: String,
-  reason: String,
-  timestamp: { type: Date, default: Date.now, expires: 86400 }
-});
-const AFK = mongoose.models.AFK || mongoose.model('AFK', afkSchema);
+// AFK state goes through the guild cache so messageCreate stays coherent
+const { clearAfk, setAfk } = require('../../../utils/guildCache');
 
 // Command Builder
 const command = new SlashCommandBuilder()
@@ -52,17 +46,9 @@ module.exports = {
         });
       }
 
-      // Check if user is already AFK
-      const existingAfk = await AFK.findOne({
-        guildId: interaction.guild.id,
-        userId: interaction.user.id
-      });
+      // Remove the AFK status if already set
+      const existingAfk = await clearAfk(interaction.guild.id, interaction.user.id);
       if (existingAfk) {
-        // Remove the AFK status if already set
-        await AFK.deleteOne({
-          guildId: interaction.guild.id,
-          userId: interaction.user.id
-        });
         await resetNickname(interaction);
         cooldowns.delete(cooldownKey);
         const timeAFK = getTimeAFK(existingAfk.timestamp);
@@ -77,11 +63,7 @@ module.exports = {
 
       // Set new AFK status
       const reason = interaction.options.getString('reason') || 'AFK';
-      await AFK.create({
-        guildId: interaction.guild.id,
-        userId: interaction.user.id,
-        reason: reason
-      });
+      await setAfk(interaction.guild.id, interaction.user.id, reason);
       // Set cooldown
       cooldowns.set(cooldownKey, Date.now() + COOLDOWN_DURATION);
 
@@ -2,7 +2,7 @@
 require('dotenv').config(); // Load .env file
 const { SlashCommandBuilder } = require('@discordjs/builders');
 const { PermissionFlagsBits } = require('discord.js');
-const GuildPrefix = require('../../../utils/guildprefix');
+const { setPrefix } = require('../../../utils/guildCache');
 const mongoose = require('mongoose');
 const { MONGODB_URI } = process.env;
 
@@ -31,12 +31,8 @@ module.exports = {
     try {
       const guildId = interaction.guild.id;
 
-      // Upsert prefix in MongoDB
-      const result = await GuildPrefix.findOneAndUpdate(
-        { guildId },
-        { prefix: newPrefix },
-        { new: true, upsert: true }
-      );
+      // Upsert prefix in MongoDB and refresh the cached prefix
+      await setPrefix(guildId, newPrefix);
 
       await interaction.reply({
         content: `Prefix updated successfully! The new prefix is \`${newPrefix}\`.`,
@@ -1,26 +1,9 @@
 const { SlashCommandBuilder, ChannelType, MessageFlags } = require('discord.js');
-const fs = require('fs');
 const path = require('path');
+const { openStore } = require('../../../utils/jsonStore');
 
-// Save the leaver config in the root directory.
-const configFilePath = path.join(process.cwd(), "leaver.json");
-
-// Helper functions to load and save config.
-function loadConfig() {
-  if (fs.existsSync(configFilePath)) {
-    try {
-      return JSON.parse(fs.readFileSync(configFilePath, 'utf8'));
-    } catch (e) {
-      console.error("Error reading leaver config:", e);
-      return {};
-    }
-  }
-  return {};
-}
-
-function saveConfig(config) {
-  fs.writeFileSync(configFilePath, JSON.stringify(config, null, 2));
-}
+// Per-guild leaver config, kept in memory and flushed in the background.
+const config = openStore(path.join(process.cwd(), "leaver.json"), { pretty: true });
 
 module.exports = {
   data: new SlashCommandBuilder()
@@ -55,14 +38,11 @@ module.exports = {
     const channel = interaction.options.getChannel('channel');
     const background = interaction.options.getAttachment('background');
 
-    let config = loadConfig();
-    config[interaction.guild.id] = {
+    config.set(interaction.guild.id, {
       enabled,
       channelId: channel.id,
       background: background ? background.url : null
-    };
-
-    saveConfig(config);
+    });
 
     await interaction.reply({
       content: `Leaver system has been ${enabled ? 'enabled' : 'disabled'} in <#${channel.id}>.`,
@@ -1,55 +1,23 @@
-const fs = require('fs');
 const path = require('path');
 const { handleChat } = require('../utils/chatUtils');
+const { openStore } = require('../utils/jsonStore');
 
-// Define the JSON file path where active channels are saved.
-const filePath = path.join(__dirname, '../data/activeChannels.json');
-
-// Load active channels from the file.
-function loadActiveChannelsFromFile() {
-  if (fs.existsSync(filePath)) {
-    try {
-      return JSON.parse(fs.readFileSync(filePath, 'utf8'));
-    } catch (err) {
-      console.error('❌ Error reading activeChannels JSON file:', err);
-    }
-  }
-  return {};
-}
+// Active channels are kept in memory and shared with the /aichat command.
+const activeChannels = openStore(path.join(__dirname, '../data/activeChannels.json'), { pretty: true });
 
 /**
  * Checks if a channel is active for AI chat.
- * For DM channels, it auto-enables them and writes the entry to the JSON file.
+ * For DM channels, it auto-enables them and records the entry.
  */
-function isActiveChannel(channelId, guildId, client) {
-  if (!client.activeChannels) client.activeChannels = new Map();
-
-  // Use "DM" as the guild ID for direct messages.
-  const key = `${guildId || "DM"}-${channelId}`;
-
-  if (client.activeChannels.has(key)) {
-    return client.activeChannels.get(key);
-  }
-
-  const fileData = loadActiveChannelsFromFile();
-  let isActive;
+function isActiveChannel(channelId, guildId) {
   if (guildId === "DM") {
-    isActive = true; // Always active for DMs.
-    // Ensure the DM section exists in the file data.
-    if (!fileData["DM"]) {
-      fileData["DM"] = {};
+    // Always active for DMs; remember the channel if it's new.
+    if (!activeChannels.get("DM")?.[channelId]) {
+      activeChannels.update("DM", (dms = {}) => ({ ...dms, [channelId]: true }));
     }
-    // If this DM channel isn't already saved, add it.
-    if (!fileData["DM"][channelId]) {
-      fileData["DM"][channelId] = true;
-      fs.writeFileSync(filePath, JSON.stringify(fileData, null, 2));
-    }
-  } else {
-    isActive = Boolean(fileData[guildId]?.[channelId]);
+    return true;
   }
-
-  client.activeChannels.set(key, isActive);
-  return isActive;
+  return Boolean(activeChannels.get(guildId)?.[channelId]);
 }
 
 module.exports = {
@@ -63,7 +31,7 @@ module.exports = {
     const channelId = message.channel.id;
 
     // Check if the message is in an active AI channel or it's a DM.
-    if (isActiveChannel(channelId, guildId, client)) {
+    if (isActiveChannel(channelId, guildId)) {
       await handleChat(message);
     }
   },
@@ -0,0 +1,10 @@
+const { invalidateGuild } = require('../utils/guildCache');
+
+module.exports = {
+  name: 'guildDelete',
+  execute(guild) {
+    // Outages also emit guildDelete (with available: false); only forget guilds we actually left.
+    if (guild.available === false) return;
+    invalidateGuild(guild.id);
+  },
+};
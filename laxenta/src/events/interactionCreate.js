@@ -2,6 +2,7 @@ const { Collection, MessageFlags } = require('discord.js');
 const { logger } = require('../utils/logger');
 const { handleButton, handlers } = require('../handlers/buttonHandler');
 const { handleCommand } = require('../handlers/commandHandler');
+const { startCommandTimer } = require('../utils/metrics');
 
 // Debug mode configuration
 const DEBUG_MODE = false; // Set to true to enable detailed logging
@@ -29,6 +30,24 @@ const debugLog = (type, message) => {
 const cooldowns = new Collection();
 const COOLDOWN_DURATION = 3000; // 3 seconds
 
+// Button customIds embed user/message ids, UUIDs and random roll ids. Metrics are labelled
+// with those parts masked, and with a hard cap on distinct labels as a backstop.
+const MAX_BUTTON_LABELS = 200;
+const buttonLabels = new Set();
+
+function buttonMetricLabel(customId) {
+    const label = customId
+        .replace(/[0-9a-f]{8}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{4}-[0-9a-f]{12}/gi, '*')
+        .split(/([_:|-])/)
+        .map(part => (part.length >= 8 && /\d/.test(part) ? '*' : part))
+        .join('');
+
+    if (buttonLabels.has(label)) return label;
+    if (buttonLabels.size >= MAX_BUTTON_LABELS) return 'other';
+    buttonLabels.add(label);
+    return label;
+}
+
 module.exports = {
     name: 'interactionCreate',
     async execute(interaction, client) {
@@ -102,7 +121,14 @@ async function handleButtonInteraction(interaction, client) {
         }
 
         debugLog('debug', `Executing button handler for ${customId}`);
-        await handleButton(interaction, client);
+        const endTimer = startCommandTimer('button', buttonMetricLabel(customId));
+        try {
+            await handleButton(interaction, client);
+            endTimer('ok');
+        } catch (error) {
+            endTimer('error');
+            throw error;
+        }
         debugLog('info', `Button interaction completed successfully - CustomID: ${customId}`);
     } catch (error) {
         debugLog('error', `Button handler error for "${customId}": ${error.message}\nStack: ${error.stack}`);
@@ -133,7 +159,14 @@ async function handleCommandInteraction(interaction, client) {
         }
 
         debugLog('debug', `Executing command handler for ${commandName}`);
-        await command.execute(interaction, client);
+        const endTimer = startCommandTimer('slash', commandName);
+        try {
+            await command.execute(interaction, client);
+            endTimer('ok');
+        } catch (error) {
+            endTimer('error');
+            throw error;
+        }
         debugLog('info', `Command executed successfully: ${commandName}`);
     } catch (error) {
         debugLog('error', `Command handler error for "${commandName}": ${error.message}\nStack: ${error.stack}`);
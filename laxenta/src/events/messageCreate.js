@@ -4,22 +4,9 @@ const mongoose = require('mongoose');
 const errorHandler = require('../handlers/errorhandler');
 const { BOT_ID } = process.env;
 const { logger, handleError } = require('../utils/logger');
-
-// Guild prefix schema & model
-const guildPrefixSchema = new mongoose.Schema({
-  guildId: { type: String, required: true, unique: true },
-  prefix: { type: String, required: true },
-});
-const GuildPrefix = mongoose.model('GuildPrefix', guildPrefixSchema);
-
-// AFK Schema & Model (auto expires after 24h)
-const afkSchema = new mongoose.Schema({
-  guildId: { type: String, required: true },
-  userId: { type: String, required: true },
-  reason: String,
-  timestamp: { type: Date, default: Date.now, expires: 86400 } // 24h expiration
-});
-const AFK = mongoose.models.AFK || mongoose.model('AFK', afkSchema);
+const { startCommandTimer, instrumentMongoose } = require('../utils/metrics');
+// Prefixes and AFK users are served from memory; see utils/guildCache.js
+const { getPrefix, clearAfk } = require('../utils/guildCache');
 
 // Cooldown collection for commands
 const cooldowns = new Collection();
@@ -29,7 +16,9 @@ const COOLDOWN_DURATION = 30000; // 30 seconds cooldown
 const mongoUri = process.env.MONGO_URI;
 if (!mongoUri) throw new Error("MONGO_URI is not defined in the environment variables.");
 
-mongoose.connect(mongoUri)
+// monitorCommands lets utils/metrics time every MongoDB operation.
+instrumentMongoose(mongoose);
+mongoose.connect(mongoUri, { monitorCommands: true })
   .then(() => console.log("Connected to MongoDB for AFK functionality."))
   .catch((err) => console.error("MongoDB connection error:", err));
 
@@ -54,16 +43,10 @@ module.exports = {
 
       // --- Global AFK Check ---
       try {
-        const afkStatus = await AFK.findOne({
-          guildId: message.guild.id,
-          userId: message.author.id,
-        });
+        // Only users in the cached AFK set reach MongoDB here.
+        const afkStatus = await clearAfk(message.guild.id, message.author.id);
         if (afkStatus) {
-          // Remove AFK status and reset nickname.
-          await AFK.deleteOne({
-            guildId: message.guild.id,
-            userId: message.author.id,
-          });
+          // AFK status is already removed, reset nickname.
           if (message.member && message.member.displayName.includes('[AFK]')) {
             try {
               await message.member.setNickname(message.member.displayName.replace('[AFK] ', ''));
@@ -112,16 +95,6 @@ module.exports = {
   },
 };
 
-async function getPrefix(guildId) {
-  try {
-    const guildSettings = await GuildPrefix.findOne({ guildId });
-    return guildSettings?.prefix || '!';
-  } catch (error) {
-    logger.error(`Error retrieving prefix for guild ${guildId}: ${error.message}`);
-    return '!';
-  }
-}
-
 function shouldIgnoreMessage(message) {
   return message.author.bot && message.author.id !== BOT_ID;
 }
@@ -147,9 +120,12 @@ async function processCommand(message, client, guildPrefix) {
     return;
   }
 
+  const endTimer = startCommandTimer('prefix', command.name || commandName);
   try {
     await command.execute(message, args, client);
+    endTimer('ok');
   } catch (error) {
+    endTimer('error');
     logger.error(`Error executing command ${commandName}`, {
       error,
       command: commandName,
@@ -72,6 +72,7 @@ const { Routes } = require('discord-api-types/v9');
 const fs = require('fs');
 const path = require('path');
 const { green, blue, red, yellow } = require('colorette');
+const { startCommandTimer } = require('../utils/metrics');
 
 const COMMAND_CACHE_FILE = './.commandCache.json';
 const environment = process.env.NODE_ENV || 'production';
@@ -191,13 +192,17 @@ function writeCommandCache(data) {
 }
 
 async function handleCommand(interaction) {
+    let endTimer = null;
     try {
         const command = interaction.client.slashCommands.get(interaction.commandName);
         if (!command) {
             throw new Error(`Command "${interaction.commandName}" not found.`);
         }
+        endTimer = startCommandTimer('slash', interaction.commandName);
         await command.execute(interaction);
+        endTimer('ok');
     } catch (error) {
+        endTimer?.('error');
         console.error(red(`Error in command handler "${interaction.commandName}": ${error.message}`));
         if (!interaction.replied && !interaction.deferred) {
             await interaction.reply({
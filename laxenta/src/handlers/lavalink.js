@@ -1,5 +1,57 @@
-const { Manager } = require('erela.js');
+const { Manager, Structure } = require('erela.js');
 const { EmbedBuilder, ActionRowBuilder, ButtonBuilder, ButtonStyle } = require('discord.js');
+const metrics = require('../utils/metrics');
+
+const lavalinkEvents = metrics.createCounter('lavalink_events_total', 'Lavalink manager events by type.', ['event']);
+const lavalinkPlayers = metrics.createGauge('lavalink_players', 'Players currently held by the manager, by state.', ['state']);
+const lavalinkNodes = metrics.createGauge('lavalink_nodes', 'Lavalink nodes by connection state.', ['state']);
+
+// Lavalink has no events for queue edits, pausing or volume changes, so the
+// player and queue announce them as "playerUpdate" for the dashboard feed.
+Structure.extend('Queue', Queue => class extends Queue {
+    add(...args) {
+        const result = super.add(...args);
+        this.onChange?.();
+        return result;
+    }
+
+    remove(...args) {
+        const result = super.remove(...args);
+        this.onChange?.();
+        return result;
+    }
+
+    clear() {
+        const result = super.clear();
+        this.onChange?.();
+        return result;
+    }
+
+    shuffle() {
+        const result = super.shuffle();
+        this.onChange?.();
+        return result;
+    }
+});
+
+Structure.extend('Player', Player => class extends Player {
+    constructor(options) {
+        super(options);
+        this.queue.onChange = () => this.manager.emit('playerUpdate', this);
+    }
+
+    pause(pause) {
+        const result = super.pause(pause);
+        this.manager.emit('playerUpdate', this);
+        return result;
+    }
+
+    setVolume(volume) {
+        const result = super.setVolume(volume);
+        this.manager.emit('playerUpdate', this);
+        return result;
+    }
+});
 
 module.exports = (client) => {
     client.manager = new Manager({
@@ -28,6 +80,26 @@ module.exports = (client) => {
         }
     });
 
+    for (const event of ['nodeConnect', 'nodeDisconnect', 'nodeError', 'trackStart', 'trackEnd', 'trackStuck', 'trackError', 'queueEnd']) {
+        client.manager.on(event, () => lavalinkEvents.inc({ event }));
+    }
+
+    metrics.addCollector(() => {
+        let playing = 0;
+        for (const player of client.manager.players.values()) {
+            if (player.playing) playing++;
+        }
+        lavalinkPlayers.set({ state: 'playing' }, playing);
+        lavalinkPlayers.set({ state: 'idle' }, client.manager.players.size - playing);
+
+        let connected = 0;
+        for (const node of client.manager.nodes.values()) {
+            if (node.connected) connected++;
+        }
+        lavalinkNodes.set({ state: 'connected' }, connected);
+        lavalinkNodes.set({ state: 'disconnected' }, client.manager.nodes.size - connected);
+    });
+
     client.manager.on("nodeConnect", node => {
         console.log(`✅ Node "${node.options.identifier}" connected successfully!`);
     });
@@ -0,0 +1,17 @@
+const mongoose = require('mongoose');
+
+// AFK Schema with auto-cleanup after 24h (86400 seconds)
+const AFK_TTL_SECONDS = 86400;
+
+const afkSchema = new mongoose.Schema({
+  guildId: { type: String, required: true },
+  userId: { type: String, required: true },
+  reason: String,
+  timestamp: { type: Date, default: Date.now, expires: AFK_TTL_SECONDS }
+});
+afkSchema.index({ guildId: 1, userId: 1 });
+
+const AFK = mongoose.models.AFK || mongoose.model('AFK', afkSchema);
+
+module.exports = AFK;
+module.exports.AFK_TTL_SECONDS = AFK_TTL_SECONDS;
@@ -0,0 +1,50 @@
+const mongoose = require('mongoose');
+
+// Schema Definition
+const birthdaySchema = new mongoose.Schema({
+  userId: { type: String, required: true, unique: true },
+  username: { type: String, required: true },
+  day: { type: Number, required: true },
+  month: { type: Number, required: true },
+  year: { type: Number },
+  timezone: { type: String }, // IANA zone, e.g. "Asia/Kolkata"; falls back to the bot's zone
+  createdAt: { type: Date, default: Date.now },
+  wishList: [{ userId: String, username: String, timestamp: Date }],
+  followers: [{ userId: String, username: String, timestamp: Date }]
+});
+
+// Optimize queries with indexes
+birthdaySchema.index({ month: 1, day: 1 });
+birthdaySchema.index({ userId: 1 });
+birthdaySchema.index({ username: 'text' });
+
+// Notified after any write, so in-memory views (the dispatcher's day list) can be dropped.
+const changeListeners = new Set();
+function onBirthdayChange(listener) {
+  changeListeners.add(listener);
+}
+for (const op of ['save', 'updateOne', 'updateMany', 'findOneAndUpdate', 'findOneAndDelete', 'deleteOne', 'deleteMany']) {
+  birthdaySchema.post(op, () => changeListeners.forEach(listener => listener()));
+}
+
+const Birthday = mongoose.models.Birthday || mongoose.model('Birthday', birthdaySchema);
+
+// One document per greeting per birthday year, so each DM goes out once.
+const birthdayDeliverySchema = new mongoose.Schema({
+  birthdayUserId: { type: String, required: true },
+  year: { type: Number, required: true },
+  recipientId: { type: String, required: true },
+  kind: { type: String, enum: ['self', 'follower'], required: true },
+  status: { type: String, enum: ['pending', 'sent', 'failed'], default: 'pending' },
+  attempts: { type: Number, default: 0 },
+  claimedAt: { type: Date, default: Date.now },
+  deliveredAt: Date,
+  error: String
+});
+birthdayDeliverySchema.index({ birthdayUserId: 1, year: 1, recipientId: 1 }, { unique: true });
+// Delivery records are only needed for the current year.
+birthdayDeliverySchema.index({ claimedAt: 1 }, { expireAfterSeconds: 60 * 60 * 24 * 400 });
+
+const BirthdayDelivery = mongoose.models.BirthdayDelivery || mongoose.model('BirthdayDelivery', birthdayDeliverySchema);
+
+module.exports = { Birthday, BirthdayDelivery, onBirthdayChange };
@@ -36,11 +36,14 @@ class MusicPlayer {
         
         this.setupEventListeners();
         
+        // Live queue feed (server-sent events), polling is only a fallback
+        this.queueFeed = null;
+        this.queueFeedGuildId = null;
+        this.queueState = null;
+        
         // Clean up on page unload
         window.addEventListener('unload', () => {
-            if (this.queuePollingInterval) {
-                clearInterval(this.queuePollingInterval);
-            }
+            this.stopQueueUpdates();
         });
     }
 
@@ -342,59 +345,7 @@ class MusicPlayer {
                 throw new Error('Failed to fetch queue');
             }
             
-            const queueData = await response.json();
-            
-            // Clear existing content
-            queueContainer.innerHTML = '';
-            
-            // Now Playing section
-            if (queueData.currentTrack) {
-                const nowPlayingSection = document.createElement('div');
-                nowPlayingSection.className = 'now-playing-section';
-                nowPlayingSection.innerHTML = `
-                    <h3>Now Playing</h3>
-                    <div class="track-item current">
-                        <img src="${queueData.currentTrack.thumbnail || '/images/default-song.png'}" alt="Thumbnail">
-                        <div class="track-info">
-                            <h4>${escapeHtml(queueData.currentTrack.title)}</h4>
-                            <p>${escapeHtml(queueData.currentTrack.author)}</p>
-                        </div>
-                        <span class="duration">${formatDuration(queueData.currentTrack.duration)}</span>
-                    </div>
-                `;
-                queueContainer.appendChild(nowPlayingSection);
-            }
-            
-            // Queue section
-            if (queueData.queue && queueData.queue.length > 0) {
-                const queueSection = document.createElement('div');
-                queueSection.className = 'queue-section';
-                queueSection.innerHTML = `<h3>Queue (${queueData.queue.length} tracks)</h3>`;
-                
-                queueData.queue.forEach((track, index) => {
-                    const trackElement = document.createElement('div');
-                    trackElement.className = 'track-item';
-                    trackElement.innerHTML = `
-                        <span class="position">#${index + 1}</span>
-                        <img src="${track.thumbnail || '/images/default-song.png'}" alt="Thumbnail">
-                        <div class="track-info">
-                            <h4>${escapeHtml(track.title)}</h4>
-                            <p>${escapeHtml(track.author)}</p>
-                        </div>
-                        <span class="duration">${formatDuration(track.duration)}</span>
-                    `;
-                    queueSection.appendChild(trackElement);
-                });
-                
-                queueContainer.appendChild(queueSection);
-            } else if (!queueData.currentTrack) {
-                queueContainer.innerHTML = `
-                    <div class="empty-queue">
-                        <i class="fas fa-music"></i>
-                        <p>No tracks in queue</p>
-                    </div>
-                `;
-            }
+            this.renderQueue(await response.json());
         } catch (error) {
             console.error('Queue display error:', error);
             if (force) {
@@ -410,6 +361,64 @@ class MusicPlayer {
             }
         }
     }
+
+    renderQueue(queueData) {
+        const queueContainer = document.getElementById('queue-container');
+        if (!queueContainer) return;
+        
+        // Clear existing content
+        queueContainer.innerHTML = '';
+        
+        // Now Playing section
+        if (queueData.currentTrack) {
+            const nowPlayingSection = document.createElement('div');
+            nowPlayingSection.className = 'now-playing-section';
+            nowPlayingSection.innerHTML = `
+                <h3>Now Playing</h3>
+                <div class="track-item current">
+                    <img src="${queueData.currentTrack.thumbnail || '/images/default-song.png'}" alt="Thumbnail">
+                    <div class="track-info">
+                        <h4>${escapeHtml(queueData.currentTrack.title)}</h4>
+                        <p>${escapeHtml(queueData.currentTrack.author)}</p>
+                    </div>
+                    <span class="duration">${formatDuration(queueData.currentTrack.duration)}</span>
+                </div>
+            `;
+            queueContainer.appendChild(nowPlayingSection);
+        }
+        
+        // Queue section
+        if (queueData.queue && queueData.queue.length > 0) {
+            const queueSection = document.createElement('div');
+            queueSection.className = 'queue-section';
+            queueSection.innerHTML = `<h3>Queue (${queueData.queue.length} tracks)</h3>`;
+            
+            queueData.queue.forEach((track, index) => {
+                const trackElement = document.createElement('div');
+                trackElement.className = 'track-item';
+                trackElement.innerHTML = `
+                    <span class="position">#${index + 1}</span>
+                    <img src="${track.thumbnail || '/images/default-song.png'}" alt="Thumbnail">
+                    <div class="track-info">
+                        <h4>${escapeHtml(track.title)}</h4>
+                        <p>${escapeHtml(track.author)}</p>
+                    </div>
+                    <span class="duration">${formatDuration(track.duration)}</span>
+                `;
+                queueSection.appendChild(trackElement);
+            });
+            
+            queueContainer.appendChild(queueSection);
+        } else if (!queueData.currentTrack) {
+            queueContainer.innerHTML = `
+                <div class="empty-queue">
+                    <i class="fas fa-music"></i>
+                    <p>No tracks in queue</p>
+                </div>
+            `;
+        }
+    }
+
     async updateLatency() {
         try {
             const start = Date.now();
@@ -454,18 +463,88 @@ class MusicPlayer {
         }, duration);
     }
 
-    // Add this method to MusicPlayer class
-    startQueuePolling(guildId) {
-        if (this.queuePollingInterval) {
-            clearInterval(this.queuePollingInterval);
+    // Follow a guild's queue: live updates over SSE, 3s polling if that is unavailable
+    startQueuePolling(guildId, force = false) {
+        if (!guildId) return;
+        if (!force && this.queueFeedGuildId === guildId && (this.queueFeed || this.queuePollingInterval)) return;
+        
+        this.stopQueueUpdates();
+        this.queueFeedGuildId = guildId;
+        
+        if (typeof EventSource === 'undefined') {
+            this.startFallbackPolling(guildId);
+            return;
         }
         
-        this.queuePollingInterval = setInterval(() => {
-            if (guildId) {
-                this.updateQueueDisplay(guildId, false);
+        const feed = new EventSource(`/api/music/events/${guildId}`);
+        this.queueFeed = feed;
+        
+        feed.addEventListener('snapshot', (event) => {
+            this.queueState = JSON.parse(event.data);
+            this.applyQueueState();
+        });
+        
+        feed.addEventListener('diff', (event) => {
+            const diff = JSON.parse(event.data);
+            // A gap means we missed something; reconnecting sends a fresh snapshot
+            if (!this.queueState || diff.seq !== this.queueState.seq + 1) {
+                this.startQueuePolling(guildId, true);
+                return;
             }
+            this.applyQueueDiff(diff);
+            this.applyQueueState();
+        });
+        
+        feed.onerror = () => {
+            // EventSource reconnects by itself unless the server refused the stream
+            if (feed.readyState === EventSource.CLOSED && this.queueFeed === feed) {
+                this.stopQueueUpdates();
+                this.queueFeedGuildId = guildId;
+                this.startFallbackPolling(guildId);
+            }
+        };
+    }
+    
+    startFallbackPolling(guildId) {
+        this.queuePollingInterval = setInterval(() => {
+            this.updateQueueDisplay(guildId, false);
         }, 3000); // Poll every 3 seconds
     }
+    
+    stopQueueUpdates() {
+        if (this.queueFeed) {
+            this.queueFeed.close();
+            this.queueFeed = null;
+        }
+        if (this.queuePollingInterval) {
+            clearInterval(this.queuePollingInterval);
+            this.queuePollingInterval = null;
+        }
+        this.queueFeedGuildId = null;
+        this.queueState = null;
+    }
+    
+    applyQueueDiff(diff) {
+        const state = this.queueState;
+        state.seq = diff.seq;
+        ['currentTrack', 'paused', 'volume', 'playing'].forEach(key => {
+            if (key in diff) state[key] = diff[key];
+        });
+        (diff.queue || []).forEach(op => {
+            state.queue.splice(op.index, op.remove, ...op.insert);
+        });
+    }
+    
+    applyQueueState() {
+        const state = this.queueState;
+        this.queues.set(this.queueFeedGuildId, state);
+        this.queueCache.set(this.queueFeedGuildId, { timestamp: Date.now(), data: state });
+        this.isPlaying = state.playing;
+        this.volume = state.volume;
+        this.queue = state.queue;
+        this.updateUI();
+        this.renderQueue(state);
+    }
 }
 
 // Initialize the music player
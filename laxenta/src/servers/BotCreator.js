@@ -1,14 +1,16 @@
 const express = require('express');
 const fs = require('fs').promises;
 const path = require('path');
-const { spawn } = require('child_process');
 const { createTemplateData } = require('./templateRouter');
+const { BotHost } = require('./botHost');
 
 class BotManager {
     constructor() {
         this.botsDir = path.join(__dirname, 'bots');
         this.memoryDir = path.join(__dirname, 'bots', 'memory');
-        this.runningBots = new Map();
+        // All user bots share a small worker-thread pool (see botHost.js)
+        this.host = new BotHost();
+        this.host.on('failed', (botId, error) => console.error(`Bot ${botId} stopped permanently: ${error}`));
         this.init();
     }
 
@@ -68,355 +70,18 @@ class BotManager {
         return botConfig;
     }
 
+    // The bot file holds the config; the code itself lives in botRuntime.js and
+    // normally runs inside BotHost. Running the file directly still works for debugging.
     async generateBotCode(filePath, config) {
         const botCode = `/*
 BOT_CONFIG:
 ${JSON.stringify(config, null, 2)}
 */
 
-const { Client, GatewayIntentBits } = require('discord.js');
-const axios = require('axios');
-const fs = require('fs').promises;
-const path = require('path');
-
-const MEMORY_DIR = path.join(__dirname, 'memory');
-
-class ${config.name.replace(/[^a-zA-Z0-9]/g, '')}Bot {
-    constructor() {
-        // Initialize client with required intents
-        this.botId = '${config.id}';
-        this.client = new Client({
-            intents: [
-                GatewayIntentBits.Guilds,
-                GatewayIntentBits.GuildMessages,
-                GatewayIntentBits.MessageContent,
-                GatewayIntentBits.GuildMembers,
-                GatewayIntentBits.DirectMessages
-            ]
-        });
-
-        // Initialize properties first
-        this.memoryCache = new Map();
-        this.activeRequests = new Map();
-        this.typingSessions = new Map();
-        this.requestTimeouts = new Map();
-        this.debug = true;
-
-        this.config = {
-            model: '${config.model}',
-            instruction: ${JSON.stringify(config.instruction)},
-            temperature: ${config.settings.temperature},
-            presence_penalty: ${config.settings.presence_penalty},
-            frequency_penalty: ${config.settings.frequency_penalty},
-            limit: ${config.settings.limit},
-            maxLength: ${config.settings.maxLength},
-            typingInterval: ${config.settings.typingInterval},
-            requestTimeout: ${config.settings.requestTimeout},
-            maxRetries: ${config.settings.maxRetries},
-            cooldown: ${config.settings.cooldown}
-        };
-
-        // Set up event handlers
-        this.setupEventHandlers();
-        
-        // Start the bot
-        this.start().catch(console.error);
-    }
-
-    setupEventHandlers() {
-        this.client.on('ready', () => {
-            console.log(\`Bot \${this.client.user.tag} is ready!\`);
-            
-            // Set presence after bot is ready
-            this.client.user.setPresence({
-                status: '${config.presence.status}',
-                activities: [{
-                    name: '${config.presence.activity}',
-                    type: '${config.presence.activityType}'
-                }]
-            }).catch(console.error);
-        });
-
-        this.client.on('messageCreate', async (message) => {
-            // Don't respond to other bots
-            if (message.author.bot) return;
-
-            // Only respond if bot is mentioned or in DMs
-            if (!message.mentions.has(this.client.user) && message.channel.type !== 1) return;
-
-            // Extract content from message
-            let content = message.content;
-            
-            // Don't process empty messages
-            if (!content) {
-                await message.reply("Hello! How can I help you?");
-                return;
-            }
-
-            try {
-                await this.processMessage(message, content);
-            } catch (error) {
-                console.error('Error processing message:', error);
-                await message.reply({
-                    content: 'An error occurred while processing your message. Please try again.',
-                    allowedMentions: { repliedUser: true }
-                }).catch(console.error);
-            }
-        });
-
-        // Add error event handlers
-        this.client.on('error', error => {
-            console.error('Discord client error:', error);
-        });
-
-        this.client.on('warn', warning => {
-            console.warn('Discord client warning:', warning);
-        });
-
-        process.on('unhandledRejection', error => {
-            console.error('Unhandled promise rejection:', error);
-        });
-    }
-
-    getRequestKey(channelId, userId) {
-        return \`\${channelId}-\${userId}\`;
-    }
-
-    getMemoryFilePath(userId) {
-        return path.join(MEMORY_DIR, \`\${this.botId}_\${userId}.json\`);
-    }
-
-    async loadMemory(userId) {
-        if (this.memoryCache.has(userId)) {
-            return this.memoryCache.get(userId);
-        }
-
-        const filePath = this.getMemoryFilePath(userId);
-        try {
-            const data = await fs.readFile(filePath, 'utf8');
-            const pairs = JSON.parse(data);
-            const memory = pairs.flatMap(pair => [
-                { 
-                    role: "user", 
-                    content: pair.user.includes(":") ? pair.user : \`unknown_user: \${pair.user}\`
-                },
-                { 
-                    role: "assistant", 
-                    content: pair.assistant 
-                }
-            ]);
-            this.memoryCache.set(userId, memory);
-            return memory;
-        } catch (err) {
-            const empty = [];
-            this.memoryCache.set(userId, empty);
-            return empty;
-        }
-    }
-
-    async saveMemory(userId, memory) {
-        const formattedMemory = [];
-        for (let i = 0; i < memory.length; i += 2) {
-            if (i + 1 < memory.length) {
-                formattedMemory.push({
-                    user: memory[i].content,
-                    assistant: memory[i + 1].content
-                });
-            }
-        }
-        
-        const filePath = this.getMemoryFilePath(userId);
-        await fs.writeFile(filePath, JSON.stringify(formattedMemory, null, 2), 'utf8');
-        this.memoryCache.set(userId, memory);
-    }
-
-    startTyping(channel, key) {
-        if (this.typingSessions.has(key)) return;
-        const sendTyping = () => channel.sendTyping().catch(() => {});
-        sendTyping();
-        const interval = setInterval(sendTyping, this.config.typingInterval);
-        this.typingSessions.set(key, interval);
-    }
-
-    cleanupRequest(key) {
-        if (this.typingSessions.has(key)) {
-            clearInterval(this.typingSessions.get(key));
-            this.typingSessions.delete(key);
-        }
-        this.activeRequests.delete(key);
-
-        if (this.requestTimeouts.has(key)) {
-            clearTimeout(this.requestTimeouts.get(key));
-            this.requestTimeouts.delete(key);
-        }
-    }
-
-    async apiCallWithRetries(url, payload, axiosConfig, retries = 2) {
-        let attempt = 0;
-        while (attempt <= retries) {
-            try {
-                const response = await Promise.race([
-                    axios.post(url, {
-                        ...payload,
-                        stream: true
-                    }, {
-                        ...axiosConfig,
-                        responseType: 'stream',
-                        timeout: this.config.requestTimeout
-                    }),
-                    new Promise((_, reject) => 
-                        setTimeout(() => reject(new Error('Request timeout')), this.config.requestTimeout)
-                    )
-                ]);
-                return response;
-            } catch (error) {
-                attempt++;
-                if (attempt > retries) throw error;
-                await new Promise(res => setTimeout(res, 1000 * attempt));
-            }
-        }
-    }
-
-    async processMessage(message, content) {
-        const key = this.getRequestKey(message.channel.id, message.author.id);
-        
-        if (this.activeRequests.has(key)) {
-            await message.reply("I'm still processing your last message! Please wait.");
-            return;
-        }
-        
-        this.activeRequests.set(key, true);
-
-        try {
-            this.startTyping(message.channel, key);
-
-            const memory = await this.loadMemory(message.author.id);
-            const formattedQuery = {
-                role: "user",
-                content: \`\${message.author.username}: \${content}\`
-            };
-            
-            const conversation = [
-                {
-                    role: "system",
-                    content: this.config.instruction
-                },
-                ...memory.slice(-this.config.limit * 2),
-                formattedQuery
-            ];
-
-            console.log('Sending conversation to API:', JSON.stringify(conversation, null, 2));
-
-            const response = await this.apiCallWithRetries(
-                'https://api.electronhub.top/v1/chat/completions',
-                {
-                    model: this.config.model,
-                    messages: conversation,
-                    temperature: this.config.temperature,
-                    presence_penalty: this.config.presence_penalty,
-                    frequency_penalty: this.config.frequency_penalty,
-                    max_tokens: this.config.maxLength
-                },
-                {
-                    headers: {
-                        'Authorization': \`Bearer \${process.env.APEXIFY_API_KEY || '${config.token}'}\`,
-                        'Content-Type': 'application/json'
-                    }
-                }
-            );
-
-            let botResponse = '';
-            
-            if (response.data.choices && response.data.choices[0] && response.data.choices[0].message) {
-                botResponse = response.data.choices[0].message.content;
-            } else {
-                throw new Error('Invalid API response format');
-            }
-
-            console.log('Bot response:', botResponse);
-
-            await message.reply({
-                content: botResponse,
-                allowedMentions: { repliedUser: false }
-            });
-
-            // Save to memory
-            const updatedMemory = [
-                ...memory,
-                formattedQuery,
-                {
-                    role: "assistant",
-                    content: botResponse
-                }
-            ];
-            
-            const memoryToSave = updatedMemory.length > this.config.limit * 2 
-                ? updatedMemory.slice(-this.config.limit * 2) 
-                : updatedMemory;
-                
-            await this.saveMemory(message.author.id, memoryToSave);
-
-        } catch (error) {
-            console.error('Process message error:', error);
-            console.error('Error stack:', error.stack);
-            
-            let errorMessage = 'Something went wrong, try again later.';
-            if (error.response && error.response.status === 401) {
-                errorMessage = 'API authentication failed. Please check the bot token.';
-            } else if (error.response && error.response.status === 429) {
-                errorMessage = 'Rate limit exceeded. Please wait a moment.';
-            }
-            
-            await message.reply({
-                content: errorMessage,
-                allowedMentions: { repliedUser: true }
-            }).catch(console.error);
-        } finally {
-            this.cleanupRequest(key);
-        }
-    }
-
-    start() {
-        return new Promise((resolve, reject) => {
-            this.client.once('ready', () => {
-                console.log(\`Bot \${this.client.user.tag} is ready!\`);
-                
-                // Set presence after bot is ready
-                this.client.user.setPresence({
-                    status: '${config.presence.status}',
-                    activities: [{
-                        name: '${config.presence.activity}',
-                        type: '${config.presence.activityType}'
-                    }]
-                }).catch(console.error);
-                
-                resolve();
-            });
-
-            this.client.login('${config.token}').catch(reject);
-        });
-    }
-}
-
-// Create and start bot instance
-const bot = new ${config.name.replace(/[^a-zA-Z0-9]/g, '')}Bot();
+const { runStandalone } = require('../botRuntime');
 
-// Handle process termination gracefully
-process.on('SIGINT', () => {
-    console.log('Shutting down bot...');
-    if (bot.client) {
-        bot.client.destroy();
-    }
-    process.exit(0);
-});
-
-process.on('SIGTERM', () => {
-    console.log('Terminating bot...');
-    if (bot.client) {
-        bot.client.destroy();
-    }
-    process.exit(0);
-});`;
+runStandalone(${JSON.stringify(config, null, 4)});
+`;
 
         await fs.writeFile(filePath, botCode);
     }
@@ -470,7 +135,8 @@ process.on('SIGTERM', () => {
                 const config = await this.getBotConfigFromFile(filePath);
                 
                 if (config && config.userId === userId) {
-                    config.isRunning = this.runningBots.has(config.id);
+                    config.isRunning = this.host.isRunning(config.id);
+                    config.runtime = this.host.getStatus(config.id);
                     config.fileName = fileName;
                     userBots.push(config);
                 }
@@ -522,6 +188,11 @@ process.on('SIGTERM', () => {
         await this.generateBotCode(filePath, updatedConfig);
         await this.saveBotConfig(filePath, updatedConfig);
 
+        // Pick up the new settings without a full process restart
+        if (this.host.isRunning(botId)) {
+            this.host.restart(updatedConfig).catch(err => console.error(`Error restarting bot ${botId}:`, err.message));
+        }
+
         return updatedConfig;
     }
 
@@ -533,20 +204,12 @@ process.on('SIGTERM', () => {
             throw new Error('Bot not found or access denied');
         }
 
-        if (this.runningBots.has(botId)) {
+        if (this.host.isRunning(botId)) {
             throw new Error('Bot is already running');
         }
 
-        const botFilePath = path.join(this.botsDir, bot.fileName);
-        const botProcess = spawn('node', [botFilePath], { 
-            stdio: 'pipe'
-        });
-
-        this.runningBots.set(botId, botProcess);
-
-        botProcess.on('exit', () => {
-            this.runningBots.delete(botId);
-        });
+        // Login happens in the background; failures show up in the bot's runtime status
+        this.host.start(bot).catch(err => console.error(`Error starting bot ${botId}:`, err.message));
 
         return true;
     }
@@ -559,14 +222,7 @@ process.on('SIGTERM', () => {
             throw new Error('Bot not found or access denied');
         }
 
-        const botProcess = this.runningBots.get(botId);
-        if (botProcess) {
-            botProcess.kill();
-            this.runningBots.delete(botId);
-            return true;
-        }
-
-        return false;
+        return this.host.stop(botId);
     }
 
     async deleteBot(botId, userId) {
@@ -657,7 +313,8 @@ process.on('SIGTERM', () => {
                 if (config && config.id === botId) {
                     return {
                         ...config,
-                        isRunning: this.runningBots.has(config.id),
+                        isRunning: this.host.isRunning(config.id),
+                        runtime: this.host.getStatus(config.id),
                         fileName: fileName
                     };
                 }
@@ -0,0 +1,231 @@
+const os = require('os');
+const path = require('path');
+const { EventEmitter } = require('events');
+const { Worker } = require('worker_threads');
+
+const WORKER_PATH = path.join(__dirname, 'botWorker.js');
+const DEFAULT_WORKERS = Number(process.env.BOT_HOST_WORKERS) || Math.min(2, os.cpus().length);
+const BASE_RESTART_DELAY = 1000;
+const MAX_RESTART_DELAY = 60000;
+const STABLE_AFTER = 5 * 60 * 1000; // a bot up this long starts its backoff over
+const STATS_TIMEOUT = 5000;
+
+/**
+ * Runs user bots inside a small pool of worker threads instead of one Node
+ * process each.
+ *
+ * Bots go to the least-loaded worker. A bot that fails is restarted on its own
+ * with exponential backoff (bad tokens are not retried); if a whole worker
+ * dies, it is replaced and its bots are started again. Workers are only
+ * spawned once the first bot starts.
+ */
+class BotHost extends EventEmitter {
+    /**
+     * @param {object} [options]
+     * @param {number} [options.workers] worker threads in the pool
+     * @param {boolean} [options.dryRun] skip gateway logins (benchmarks)
+     */
+    constructor({ workers = DEFAULT_WORKERS, dryRun = false } = {}) {
+        super();
+        this.size = Math.max(1, workers);
+        this.dryRun = dryRun;
+        this.workers = []; // { worker, bots: Set<botId> }
+        this.bots = new Map(); // botId -> { config, slot, status, restarts, ... }
+        this.statsRequests = new Map();
+        this.nextRequestId = 1;
+        this.closing = false;
+    }
+
+    // ---- Workers ------------------------------------------------------------
+
+    spawnWorker(index) {
+        const worker = new Worker(WORKER_PATH, { workerData: { dryRun: this.dryRun } });
+        const slot = this.workers[index] || { bots: new Set() };
+        slot.worker = worker;
+        slot.index = index;
+        this.workers[index] = slot;
+
+        worker.on('message', (message) => this.handleMessage(slot, message));
+        worker.on('error', (error) => console.error(`Bot worker ${index} crashed:`, error));
+        worker.on('exit', (code) => {
+            if (this.closing || slot.worker !== worker) return;
+            console.error(`Bot worker ${index} exited with code ${code}, restarting its ${slot.bots.size} bot(s)`);
+            this.spawnWorker(index);
+            for (const botId of [...slot.bots]) {
+                const bot = this.bots.get(botId);
+                if (bot) this.scheduleRestart(bot, `worker exited with code ${code}`);
+            }
+        });
+        return slot;
+    }
+
+    // Least-loaded worker; the pool only grows while every worker already has bots.
+    pickWorker() {
+        const least = this.workers.reduce((best, slot) => (!best || slot.bots.size < best.bots.size ? slot : best), null);
+        if (least && (least.bots.size === 0 || this.workers.length >= this.size)) return least;
+        return this.spawnWorker(this.workers.length);
+    }
+
+    handleMessage(slot, message) {
+        if (message.type === 'stats') {
+            const resolve = this.statsRequests.get(message.requestId);
+            this.statsRequests.delete(message.requestId);
+            resolve?.({ worker: slot.index, bots: message.bots, heapUsed: message.heapUsed });
+            return;
+        }
+
+        const bot = this.bots.get(message.botId);
+        if (!bot || bot.slot !== slot) return;
+
+        switch (message.status) {
+            case 'ready':
+                bot.status = 'running';
+                bot.readyAt = Date.now();
+                bot.startupMs = message.startupMs;
+                bot.lastError = null;
+                bot.waiters.splice(0).forEach(w => w.resolve(bot.startupMs));
+                this.emit('ready', bot.config.id, message);
+                break;
+            case 'error':
+                bot.lastError = message.error;
+                if (message.fatal) {
+                    this.detach(bot);
+                    bot.status = 'failed';
+                    bot.waiters.splice(0).forEach(w => w.reject(new Error(message.error)));
+                    this.emit('failed', bot.config.id, message.error);
+                } else {
+                    this.scheduleRestart(bot, message.error);
+                }
+                break;
+        }
+    }
+
+    // ---- Bots ---------------------------------------------------------------
+
+    /**
+     * Start (or replace) a bot. Resolves with its startup time once it is ready.
+     * @returns {Promise<number>}
+     */
+    start(config) {
+        const existing = this.bots.get(config.id);
+        if (existing) this.remove(existing);
+
+        const bot = {
+            config,
+            slot: null,
+            status: 'starting',
+            restarts: 0,
+            readyAt: null,
+            startupMs: null,
+            lastError: null,
+            restartTimer: null,
+            waiters: []
+        };
+        this.bots.set(config.id, bot);
+
+        const ready = new Promise((resolve, reject) => bot.waiters.push({ resolve, reject }));
+        this.launch(bot);
+        return ready;
+    }
+
+    launch(bot) {
+        const slot = this.pickWorker();
+        bot.slot = slot;
+        bot.status = 'starting';
+        slot.bots.add(bot.config.id);
+        slot.worker.postMessage({ type: 'start', config: bot.config });
+    }
+
+    detach(bot) {
+        clearTimeout(bot.restartTimer);
+        bot.restartTimer = null;
+        if (bot.slot) {
+            bot.slot.bots.delete(bot.config.id);
+            bot.slot = null;
+        }
+    }
+
+    scheduleRestart(bot, reason) {
+        if (bot.readyAt && Date.now() - bot.readyAt > STABLE_AFTER) bot.restarts = 0;
+        this.detach(bot);
+        bot.status = 'restarting';
+
+        const delay = Math.min(BASE_RESTART_DELAY * 2 ** bot.restarts, MAX_RESTART_DELAY);
+        bot.restarts++;
+        console.warn(`Bot ${bot.config.name} (${bot.config.id}) failed: ${reason}; restarting in ${delay}ms`);
+        bot.restartTimer = setTimeout(() => {
+            bot.restartTimer = null;
+            if (this.bots.get(bot.config.id) === bot) this.launch(bot);
+        }, delay);
+        bot.restartTimer.unref?.();
+    }
+
+    remove(bot) {
+        const slot = bot.slot;
+        this.detach(bot);
+        this.bots.delete(bot.config.id);
+        bot.status = 'stopped';
+        bot.waiters.splice(0).forEach(w => w.reject(new Error('Bot stopped before it was ready')));
+        slot?.worker.postMessage({ type: 'stop', botId: bot.config.id });
+    }
+
+    stop(botId) {
+        const bot = this.bots.get(botId);
+        if (!bot) return false;
+        this.remove(bot);
+        return true;
+    }
+
+    /**
+     * Restart a running bot, e.g. with an updated config.
+     */
+    restart(config) {
+        return this.start(config);
+    }
+
+    isRunning(botId) {
+        const bot = this.bots.get(botId);
+        return Boolean(bot) && bot.status !== 'failed';
+    }
+
+    getStatus(botId) {
+        const bot = this.bots.get(botId);
+        if (!bot) return { status: 'stopped' };
+        return {
+            status: bot.status,
+            worker: bot.slot?.index ?? null,
+            restarts: bot.restarts,
+            startupMs: bot.startupMs,
+            lastError: bot.lastError
+        };
+    }
+
+    async getStats() {
+        const workers = await Promise.all(this.workers.map(slot => new Promise((resolve) => {
+            const requestId = this.nextRequestId++;
+            // A stuck worker is reported as unresponsive instead of stalling the whole call.
+            const timer = setTimeout(() => {
+                this.statsRequests.delete(requestId);
+                resolve({ worker: slot.index, bots: slot.bots.size, heapUsed: null, timedOut: true });
+            }, STATS_TIMEOUT);
+            this.statsRequests.set(requestId, (stats) => {
+                clearTimeout(timer);
+                resolve(stats);
+            });
+            slot.worker.postMessage({ type: 'stats', requestId });
+        })));
+
+        const byStatus = {};
+        for (const bot of this.bots.values()) byStatus[bot.status] = (byStatus[bot.status] || 0) + 1;
+        return { rss: process.memoryUsage().rss, bots: this.bots.size, byStatus, workers };
+    }
+
+    async close() {
+        this.closing = true;
+        for (const bot of [...this.bots.values()]) this.remove(bot);
+        await Promise.all(this.workers.map(slot => slot.worker.terminate()));
+        this.workers = [];
+    }
+}
+
+module.exports = { BotHost };
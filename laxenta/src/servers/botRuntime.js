@@ -0,0 +1,392 @@
+const https = require('https');
+const path = require('path');
+const axios = require('axios');
+const { Client, GatewayIntentBits, Partials, Options, ActivityType } = require('discord.js');
+const { readCompletionStream, EditScheduler, HistoryStore, StreamStats } = require('../utils/aiStream');
+
+/**
+ * Runtime for user-created AI bots.
+ *
+ * Many HostedBots share one module graph (discord.js, axios, ...) and one set
+ * of HTTP agents per thread, so each extra bot only pays for its own client
+ * state. botWorker.js hosts them inside worker threads; a generated bot file
+ * can still run a single bot on its own through runStandalone().
+ */
+
+const MEMORY_DIR = path.join(__dirname, 'bots', 'memory');
+const COMPLETIONS_URL = 'https://api.electronhub.top/v1/chat/completions';
+const AI_CONCURRENCY = Number(process.env.BOT_AI_CONCURRENCY) || 16;
+
+// Completions are billed to the host's key; a user's Discord token must never be sent to the API.
+const apiKey = () => process.env.APEXIFY_API_KEY;
+
+// Errors that a restart will never fix.
+const FATAL_LOGIN_ERRORS = new Set(['TokenInvalid', 'DisallowedIntents']);
+
+let shared = null;
+
+/**
+ * Limits how many completions this thread streams at once, across all bots.
+ */
+class AiRequestQueue {
+    constructor(concurrency) {
+        this.concurrency = concurrency;
+        this.active = 0;
+        this.waiting = [];
+    }
+
+    run(job) {
+        return new Promise((resolve, reject) => {
+            this.waiting.push({ job, resolve, reject });
+            this.next();
+        });
+    }
+
+    next() {
+        while (this.active < this.concurrency && this.waiting.length > 0) {
+            const { job, resolve, reject } = this.waiting.shift();
+            this.active++;
+            Promise.resolve().then(job).then(resolve, reject).finally(() => {
+                this.active--;
+                this.next();
+            });
+        }
+    }
+}
+
+/**
+ * Per-thread resources every bot in the thread reuses.
+ */
+function getSharedResources() {
+    if (shared) return shared;
+
+    let restAgent = null;
+    try {
+        // One connection pool for every bot's Discord REST calls.
+        const { Agent } = require('undici');
+        restAgent = new Agent({ connect: { timeout: 30000 }, keepAliveTimeout: 30000 });
+    } catch {
+        // Fall back to discord.js' own agent per client.
+    }
+
+    shared = {
+        httpsAgent: new https.Agent({ keepAlive: true, maxSockets: AI_CONCURRENCY }),
+        restAgent,
+        aiQueue: new AiRequestQueue(AI_CONCURRENCY),
+    };
+    return shared;
+}
+
+/**
+ * A client that keeps only what an AI chat bot needs. Messages arrive with
+ * everything required to reply, so nothing is cached beyond guilds/channels.
+ */
+function createClient(resources) {
+    return new Client({
+        intents: [
+            GatewayIntentBits.Guilds,
+            GatewayIntentBits.GuildMessages,
+            GatewayIntentBits.MessageContent,
+            GatewayIntentBits.DirectMessages
+        ],
+        partials: [Partials.Channel], // DM channels are never cached up front
+        makeCache: Options.cacheWithLimits({
+            ...Options.DefaultMakeCacheSettings,
+            MessageManager: 0,
+            GuildMemberManager: {
+                maxSize: 0,
+                keepOverLimit: member => member.id === member.client.user.id
+            },
+            UserManager: 0,
+            PresenceManager: 0,
+            ReactionManager: 0,
+            ReactionUserManager: 0,
+            GuildEmojiManager: 0,
+            GuildStickerManager: 0,
+            GuildScheduledEventManager: 0,
+            GuildInviteManager: 0,
+            GuildBanManager: 0,
+            StageInstanceManager: 0,
+            ThreadMemberManager: 0,
+            VoiceStateManager: 0,
+            AutoModerationRuleManager: 0
+        }),
+        sweepers: {
+            ...Options.DefaultSweeperSettings,
+            threads: { interval: 3600, lifetime: 3600 }
+        },
+        ...(resources.restAgent && { rest: { agent: resources.restAgent } })
+    });
+}
+
+function toActivityType(type) {
+    const name = String(type || 'PLAYING').toLowerCase();
+    const key = Object.keys(ActivityType).find(k => isNaN(k) && k.toLowerCase() === name);
+    return key ? ActivityType[key] : ActivityType.Playing;
+}
+
+class HostedBot {
+    /**
+     * @param {object} config bot config as stored by BotManager
+     * @param {object} [options]
+     * @param {boolean} [options.dryRun] build everything but skip the gateway login (benchmarks)
+     * @param {function} [options.onStatus] called with ('ready'|'error'|'stopped', details)
+     */
+    constructor(config, { dryRun = false, onStatus = () => {}, resources = getSharedResources() } = {}) {
+        this.botId = config.id;
+        this.name = config.name;
+        this.token = config.token;
+        this.presence = config.presence || {};
+        this.dryRun = dryRun;
+        this.onStatus = onStatus;
+        this.resources = resources;
+        this.stopped = false;
+
+        this.config = {
+            model: config.model,
+            instruction: config.instruction,
+            ...config.settings
+        };
+
+        this.activeRequests = new Set();
+        this.typingSessions = new Map();
+
+        // Conversation history: bounded LRU in memory, appended to MEMORY_DIR
+        this.history = new HistoryStore({
+            dir: MEMORY_DIR,
+            filePrefix: `${this.botId}_`,
+            replyRole: 'assistant',
+            limit: this.config.limit * 2
+        });
+        this.stats = new StreamStats();
+
+        this.client = createClient(resources);
+        this.setupEventHandlers();
+    }
+
+    log(...args) {
+        console.log(`[bot ${this.name}]`, ...args);
+    }
+
+    setupEventHandlers() {
+        this.client.once('ready', () => {
+            this.log(`${this.client.user.tag} is ready!`);
+            this.applyPresence();
+        });
+
+        this.client.on('messageCreate', (message) => {
+            this.handleMessage(message).catch(error => this.log('Error processing message:', error.message));
+        });
+
+        this.client.on('error', error => this.log('Discord client error:', error.message));
+        this.client.on('warn', warning => this.log('Discord client warning:', warning));
+
+        // The session can't be resumed (e.g. token reset); hand it back to the host to restart.
+        this.client.on('invalidated', () => {
+            if (!this.stopped) this.onStatus('error', { error: 'Session invalidated', fatal: false });
+        });
+    }
+
+    applyPresence() {
+        this.client.user.setPresence({
+            status: this.presence.status || 'online',
+            activities: [{
+                name: this.presence.activity || 'with humans',
+                type: toActivityType(this.presence.activityType)
+            }]
+        });
+    }
+
+    async start() {
+        const startedAt = Date.now();
+        if (this.dryRun) {
+            this.onStatus('ready', { startupMs: Date.now() - startedAt });
+            return;
+        }
+
+        if (!apiKey()) {
+            this.onStatus('error', { error: 'APEXIFY_API_KEY is not set', fatal: true });
+            return;
+        }
+
+        try {
+            const ready = new Promise(resolve => this.client.once('ready', resolve));
+            await this.client.login(this.token);
+            await ready;
+            this.onStatus('ready', { startupMs: Date.now() - startedAt, tag: this.client.user.tag });
+        } catch (error) {
+            this.onStatus('error', {
+                error: error.message,
+                fatal: FATAL_LOGIN_ERRORS.has(error.code) || /disallowed intents|invalid token/i.test(error.message)
+            });
+        }
+    }
+
+    async stop() {
+        this.stopped = true;
+        for (const interval of this.typingSessions.values()) clearInterval(interval);
+        this.typingSessions.clear();
+        await this.client.destroy();
+        this.onStatus('stopped', {});
+    }
+
+    async handleMessage(message) {
+        // Don't respond to other bots
+        if (message.author.bot) return;
+
+        // Only respond if bot is mentioned or in DMs
+        if (!message.mentions.has(this.client.user) && message.channel.type !== 1) return;
+
+        const content = message.content;
+        if (!content) {
+            await message.reply("Hello! How can I help you?");
+            return;
+        }
+
+        try {
+            await this.processMessage(message, content);
+        } catch (error) {
+            this.log('Error processing message:', error.message);
+            await message.reply({
+                content: 'An error occurred while processing your message. Please try again.',
+                allowedMentions: { repliedUser: true }
+            }).catch(() => {});
+        }
+    }
+
+    startTyping(channel, key) {
+        if (this.typingSessions.has(key)) return;
+        const sendTyping = () => channel.sendTyping().catch(() => {});
+        sendTyping();
+        this.typingSessions.set(key, setInterval(sendTyping, this.config.typingInterval));
+    }
+
+    cleanupRequest(key) {
+        clearInterval(this.typingSessions.get(key));
+        this.typingSessions.delete(key);
+        this.activeRequests.delete(key);
+    }
+
+    /**
+     * POST a streaming completion through the thread's shared agent. Only the
+     * wait for response headers is bounded by requestTimeout; the stream
+     * itself may take as long as the model needs.
+     */
+    async requestCompletion(payload) {
+        const key = apiKey();
+        if (!key) throw new Error('APEXIFY_API_KEY is not set');
+
+        const retries = this.config.maxRetries ?? 2;
+        for (let attempt = 0; ; attempt++) {
+            const controller = new AbortController();
+            const timer = setTimeout(() => controller.abort(), this.config.requestTimeout);
+            try {
+                return await axios.post(COMPLETIONS_URL, { ...payload, stream: true }, {
+                    headers: {
+                        'Authorization': `Bearer ${key}`,
+                        'Content-Type': 'application/json'
+                    },
+                    responseType: 'stream',
+                    httpsAgent: this.resources.httpsAgent,
+                    signal: controller.signal
+                });
+            } catch (error) {
+                const status = error.response?.status;
+                if (attempt >= retries || status === 401 || status === 400) throw error;
+                await new Promise(res => setTimeout(res, 1000 * (attempt + 1)));
+            } finally {
+                clearTimeout(timer);
+            }
+        }
+    }
+
+    async processMessage(message, content) {
+        const receivedAt = Date.now();
+        const key = `${message.channel.id}-${message.author.id}`;
+
+        if (this.activeRequests.has(key)) {
+            await message.reply("I'm still processing your last message! Please wait.");
+            return;
+        }
+        this.activeRequests.add(key);
+
+        try {
+            this.startTyping(message.channel, key);
+
+            const memory = await this.history.get(message.author.id);
+            const formattedQuery = {
+                role: "user",
+                content: `${message.author.username}: ${content}`
+            };
+
+            const conversation = [
+                { role: "system", content: this.config.instruction },
+                ...memory.slice(-this.config.limit * 2),
+                formattedQuery
+            ];
+
+            const botResponse = await this.resources.aiQueue.run(async () => {
+                const response = await this.requestCompletion({
+                    model: this.config.model,
+                    messages: conversation,
+                    temperature: this.config.temperature,
+                    presence_penalty: this.config.presence_penalty,
+                    frequency_penalty: this.config.frequency_penalty,
+                    max_tokens: this.config.maxLength
+                });
+
+                const sentMessage = await message.reply({
+                    content: '...',
+                    allowedMentions: { repliedUser: false }
+                });
+
+                // Stream tokens into the reply with coalesced, rate-aware edits
+                const editor = new EditScheduler(sentMessage, { startedAt: receivedAt });
+                const text = await readCompletionStream(response.data, (delta, full) => editor.update(full));
+                if (!text) throw new Error('Empty API response');
+                this.stats.record(await editor.finish(text));
+                return text;
+            });
+
+            await this.history.append(message.author.id, formattedQuery.content, botResponse);
+        } catch (error) {
+            this.log('Process message error:', error.message);
+
+            let errorMessage = 'Something went wrong, try again later.';
+            if (error.response && error.response.status === 401) {
+                errorMessage = 'API authentication failed. Please check the bot token.';
+            } else if (error.response && error.response.status === 429) {
+                errorMessage = 'Rate limit exceeded. Please wait a moment.';
+            }
+
+            await message.reply({
+                content: errorMessage,
+                allowedMentions: { repliedUser: true }
+            }).catch(() => {});
+        } finally {
+            this.cleanupRequest(key);
+        }
+    }
+}
+
+/**
+ * Run a single bot in the current process (used by generated bot files).
+ */
+function runStandalone(config) {
+    const bot = new HostedBot(config, {
+        onStatus: (status, details) => {
+            if (status === 'error') console.error(`Bot ${config.name} failed:`, details.error);
+        }
+    });
+    bot.start().catch(error => console.error(`Bot ${config.name} failed to start:`, error));
+
+    const shutdown = () => {
+        console.log('Shutting down bot...');
+        bot.stop().finally(() => process.exit(0));
+    };
+    process.on('SIGINT', shutdown);
+    process.on('SIGTERM', shutdown);
+    return bot;
+}
+
+module.exports = { HostedBot, AiRequestQueue, getSharedResources, runStandalone };
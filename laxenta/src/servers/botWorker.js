@@ -0,0 +1,77 @@
+const { parentPort, workerData } = require('worker_threads');
+const v8 = require('v8');
+const { HostedBot } = require('./botRuntime');
+
+/**
+ * Worker-thread entry for BotHost. Runs any number of HostedBots and reports
+ * their status back; a failure in one bot never takes the others down.
+ */
+
+const dryRun = Boolean(workerData?.dryRun);
+const bots = new Map(); // botId -> HostedBot
+
+function report(botId, status, details = {}) {
+    parentPort.postMessage({ type: 'status', botId, status, ...details });
+}
+
+async function startBot(config) {
+    if (bots.has(config.id)) await stopBot(config.id);
+
+    let bot;
+    try {
+        bot = new HostedBot(config, {
+            dryRun,
+            onStatus: (status, details) => {
+                // Ignore late events from an instance that has since been replaced
+                if (bots.get(config.id) !== bot) return;
+                if (status === 'error') {
+                    bots.delete(config.id);
+                    bot.stop().catch(() => {});
+                }
+                report(config.id, status, details);
+            }
+        });
+    } catch (error) {
+        report(config.id, 'error', { error: error.message, fatal: true });
+        return;
+    }
+
+    bots.set(config.id, bot);
+    await bot.start();
+}
+
+async function stopBot(botId) {
+    const bot = bots.get(botId);
+    if (!bot) return;
+    bots.delete(botId);
+    try {
+        await bot.stop();
+    } catch (error) {
+        console.error(`Error stopping bot ${botId}:`, error.message);
+    }
+}
+
+parentPort.on('message', (message) => {
+    switch (message.type) {
+        case 'start':
+            startBot(message.config).catch(error =>
+                report(message.config.id, 'error', { error: error.message, fatal: false }));
+            break;
+        case 'stop':
+            stopBot(message.botId).finally(() => report(message.botId, 'stopped'));
+            break;
+        case 'stats':
+            parentPort.postMessage({
+                type: 'stats',
+                requestId: message.requestId,
+                bots: bots.size,
+                heapUsed: v8.getHeapStatistics().used_heap_size
+            });
+            break;
+    }
+});
+
+// A stray rejection from one bot's handlers must not kill every bot in this thread.
+process.on('unhandledRejection', (error) => {
+    console.error('Unhandled rejection in bot worker:', error);
+});
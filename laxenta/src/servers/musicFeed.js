@@ -0,0 +1,238 @@
+/**
+ * Server-sent event feed for the dashboard music player.
+ *
+ * Subscribers are grouped per guild. Player state is only serialised for
+ * guilds that have someone watching, and after the initial snapshot each
+ * change is sent as a diff: the scalar fields that changed plus the queue
+ * splices that bring the client's copy up to date. Nothing runs while
+ * nobody is subscribed apart from the Manager listeners themselves.
+ */
+
+const HEARTBEAT_INTERVAL = 25000; // keeps proxies from closing idle streams
+const MAX_BUFFERED_BYTES = 256 * 1024; // drop clients that stop reading
+
+// Manager events that can change what the dashboard shows.
+const PLAYER_EVENTS = [
+    'playerCreate',
+    'playerDestroy',
+    'playerMove',
+    'playerUpdate',
+    'trackStart',
+    'trackEnd',
+    'queueEnd'
+];
+
+function serializeTrack(track) {
+    return {
+        title: track.title,
+        author: track.author,
+        duration: track.duration,
+        thumbnail: track.thumbnail,
+        uri: track.uri,
+        requester: track.requester
+    };
+}
+
+/**
+ * Queue state in the shape `/api/music/queue/:guildId` has always returned.
+ */
+function buildQueueState(player) {
+    if (!player) {
+        return {
+            currentTrack: null,
+            queue: [],
+            paused: false,
+            volume: 100,
+            playing: false
+        };
+    }
+
+    return {
+        currentTrack: player.queue.current ? serializeTrack(player.queue.current) : null,
+        queue: Array.from(player.queue, serializeTrack),
+        paused: player.paused,
+        volume: player.volume,
+        playing: player.playing
+    };
+}
+
+/**
+ * Splices (applied in order) turning `before` into `after`, comparing tracks
+ * by identity. Tracks that finished playing are dropped from the front first,
+ * so a track starting while others are added stays cheap; whatever else
+ * changed is covered by one splice around the common prefix and suffix.
+ */
+function diffQueue(before, after) {
+    const ops = [];
+
+    const shifted = after.length > 0 ? before.indexOf(after[0]) : -1;
+    if (shifted > 0) {
+        ops.push({ index: 0, remove: shifted, insert: [] });
+        before = before.slice(shifted);
+    }
+
+    let start = 0;
+    while (start < before.length && start < after.length && before[start] === after[start]) {
+        start++;
+    }
+
+    let end = 0;
+    while (
+        end < before.length - start &&
+        end < after.length - start &&
+        before[before.length - 1 - end] === after[after.length - 1 - end]
+    ) {
+        end++;
+    }
+
+    const remove = before.length - start - end;
+    const insert = after.slice(start, after.length - end);
+    if (remove > 0 || insert.length > 0) {
+        ops.push({ index: start, remove, insert: insert.map(serializeTrack) });
+    }
+    return ops.length > 0 ? ops : null;
+}
+
+class MusicFeed {
+    constructor(client) {
+        this.client = client;
+        this.subscribers = new Map(); // guildId -> Set<res>
+        this.states = new Map();      // guildId -> last state sent to subscribers
+        this.pending = new Set();     // guildIds with a publish queued this tick
+        this.heartbeat = null;
+        this.stats = { connections: 0, snapshots: 0, diffs: 0, dropped: 0 };
+
+        for (const event of PLAYER_EVENTS) {
+            client.manager.on(event, (player) => this.schedule(player.guild));
+        }
+    }
+
+    /**
+     * Attach an SSE response to a guild's feed and send it a full snapshot.
+     */
+    subscribe(guildId, req, res) {
+        res.writeHead(200, {
+            'Content-Type': 'text/event-stream',
+            'Cache-Control': 'no-cache, no-transform',
+            'Connection': 'keep-alive',
+            'X-Accel-Buffering': 'no'
+        });
+        res.write('retry: 3000\n\n');
+
+        let clients = this.subscribers.get(guildId);
+        if (clients) {
+            // Bring existing subscribers up to date so the shared baseline is current.
+            this.publish(guildId);
+        } else {
+            clients = new Set();
+            this.subscribers.set(guildId, clients);
+            this.states.set(guildId, this.capture(guildId));
+        }
+        clients.add(res);
+        this.stats.connections++;
+        this.startHeartbeat();
+
+        const state = this.states.get(guildId);
+        this.send(guildId, res, 'snapshot', { seq: state.seq, ...state.data });
+        this.stats.snapshots++;
+
+        req.on('close', () => this.unsubscribe(guildId, res));
+        res.on('error', () => this.unsubscribe(guildId, res));
+    }
+
+    unsubscribe(guildId, res) {
+        const clients = this.subscribers.get(guildId);
+        if (!clients || !clients.delete(res)) return;
+
+        if (clients.size === 0) {
+            this.subscribers.delete(guildId);
+            this.states.delete(guildId);
+        }
+        if (this.subscribers.size === 0) this.stopHeartbeat();
+    }
+
+    /**
+     * Coalesce bursts of Manager events (e.g. trackEnd + trackStart) into one publish.
+     */
+    schedule(guildId) {
+        if (!this.subscribers.has(guildId) || this.pending.has(guildId)) return;
+        this.pending.add(guildId);
+        setImmediate(() => {
+            this.pending.delete(guildId);
+            this.publish(guildId);
+        });
+    }
+
+    publish(guildId) {
+        const clients = this.subscribers.get(guildId);
+        const previous = this.states.get(guildId);
+        if (!clients || !previous || clients.size === 0) return;
+
+        const next = this.capture(guildId, previous.seq + 1);
+        const diff = {};
+        for (const key of ['paused', 'volume', 'playing']) {
+            if (next.data[key] !== previous.data[key]) diff[key] = next.data[key];
+        }
+        if (next.current !== previous.current) diff.currentTrack = next.data.currentTrack;
+        const queue = diffQueue(previous.tracks, next.tracks);
+        if (queue) diff.queue = queue;
+
+        if (Object.keys(diff).length === 0) return;
+
+        this.states.set(guildId, next);
+        this.stats.diffs++;
+        for (const res of clients) {
+            this.send(guildId, res, 'diff', { seq: next.seq, ...diff });
+        }
+    }
+
+    capture(guildId, seq = 0) {
+        const player = this.client.manager.players.get(guildId);
+        return {
+            seq,
+            current: player?.queue.current || null,
+            tracks: player ? [...player.queue] : [],
+            data: buildQueueState(player)
+        };
+    }
+
+    send(guildId, res, event, payload) {
+        if (res.writableEnded) {
+            this.unsubscribe(guildId, res);
+            return;
+        }
+        if (res.writableLength > MAX_BUFFERED_BYTES) {
+            // The client will reconnect and start over from a fresh snapshot.
+            this.stats.dropped++;
+            this.unsubscribe(guildId, res);
+            res.end();
+            return;
+        }
+        res.write(`event: ${event}\ndata: ${JSON.stringify(payload)}\n\n`);
+    }
+
+    startHeartbeat() {
+        if (this.heartbeat) return;
+        this.heartbeat = setInterval(() => {
+            for (const clients of this.subscribers.values()) {
+                for (const res of clients) {
+                    if (!res.writableEnded) res.write(': ping\n\n');
+                }
+            }
+        }, HEARTBEAT_INTERVAL);
+        this.heartbeat.unref?.();
+    }
+
+    stopHeartbeat() {
+        if (this.heartbeat) clearInterval(this.heartbeat);
+        this.heartbeat = null;
+    }
+
+    getStats() {
+        let subscribers = 0;
+        for (const clients of this.subscribers.values()) subscribers += clients.size;
+        return { ...this.stats, guilds: this.subscribers.size, subscribers };
+    }
+}
+
+module.exports = { MusicFeed, buildQueueState, serializeTrack, diffQueue };
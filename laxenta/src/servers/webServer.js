@@ -9,6 +9,11 @@ const DiscordAuthManager = require('../auth/discordAuth');
 const MongoStore = require('connect-mongo');
 const User = require('../models/User');
 const cookieParser = require('cookie-parser');
+const { MusicFeed, buildQueueState } = require('./musicFeed');
+const metrics = require('../utils/metrics');
+const { logger } = require('../utils/logger');
+const { getCacheStats } = require('../utils/guildCache');
+const { getBirthdayDispatchStats } = require('../utils/birthdayDispatcher');
 
 class WebServer {
     constructor(client) {
@@ -16,6 +21,8 @@ class WebServer {
         this.app = express();
         this.userVoiceMap = new Map(); // Add this line
         this.setupVoiceStateTracking(); // Add this line
+        this.musicFeed = new MusicFeed(client);
+        this.setupMetrics();
 
  
         // Initialize auth handlers
@@ -115,6 +122,61 @@ class WebServer {
     });
 }
 //above is new codeWEEEEEEEEEEEEEEEEEEEE 
+
+    // Stats other modules keep for themselves, mirrored into /api/metrics at scrape time
+    setupMetrics() {
+        const cacheRequests = metrics.createCounter('bot_cache_requests_total', 'Guild cache lookups by cache and result.', ['cache', 'result']);
+        const cacheHitRatio = metrics.createGauge('bot_cache_hit_ratio', 'Share of guild cache lookups served from memory.', ['cache']);
+        const cacheEntries = metrics.createGauge('bot_cache_entries', 'Entries held by the guild cache.', ['cache']);
+        const aiReplies = metrics.createCounter('ai_stream_replies_total', 'Streamed AI chat replies.');
+        const aiEdits = metrics.createGauge('ai_stream_edits_per_reply', 'Average message edits per streamed reply.');
+        const aiFirstToken = metrics.createGauge('ai_stream_first_visible_token_seconds', 'Average time until the first streamed token is visible.');
+        const birthdays = metrics.createCounter('birthday_deliveries_total', 'Birthday greetings by outcome.', ['result']);
+        const feedSubscribers = metrics.createGauge('music_feed_subscribers', 'Open dashboard music feed connections.');
+        const feedDiffs = metrics.createCounter('music_feed_diffs_total', 'Queue diffs pushed to dashboard subscribers.');
+        const logLines = metrics.createCounter('log_lines_total', 'Log lines accepted by the logger, by level.', ['level']);
+        const logDropped = metrics.createCounter('log_lines_dropped_total', 'Log lines dropped because output was backed up.');
+
+        metrics.addCollector(() => {
+            const cache = getCacheStats();
+            // hit = answered from memory, miss = went to MongoDB. For AFK, afkHits/afkMisses both
+            // count MongoDB lookups (document found or not); afkSkipped counts the ones avoided.
+            for (const [name, hits, misses, size] of [
+                ['prefix', cache.prefixHits, cache.prefixMisses, cache.prefixes],
+                ['afk', cache.afkSkipped, cache.afkHits + cache.afkMisses, cache.afkUsers]
+            ]) {
+                cacheRequests.set({ cache: name, result: 'hit' }, hits);
+                cacheRequests.set({ cache: name, result: 'miss' }, misses);
+                cacheHitRatio.set({ cache: name }, hits + misses > 0 ? hits / (hits + misses) : 0);
+                cacheEntries.set({ cache: name }, size);
+            }
+
+            // chatUtils is loaded by the AI commands; only report once it exists
+            const chatUtilsPath = require.resolve('../utils/chatUtils');
+            if (require.cache[chatUtilsPath]) {
+                const ai = require(chatUtilsPath).getStreamStats();
+                aiReplies.set({}, ai.replies);
+                aiEdits.set({}, ai.avgEditsPerReply);
+                if (ai.avgTimeToFirstVisibleTokenMs !== null) aiFirstToken.set({}, ai.avgTimeToFirstVisibleTokenMs / 1000);
+            }
+
+            const birthday = getBirthdayDispatchStats();
+            for (const result of ['sent', 'failed', 'skipped']) {
+                birthdays.set({ result }, birthday[result]);
+            }
+
+            const feed = this.musicFeed.getStats();
+            feedSubscribers.set({}, feed.subscribers);
+            feedDiffs.set({}, feed.diffs);
+
+            const logs = logger.getStats();
+            for (const [level, count] of Object.entries(logs.lines)) {
+                logLines.set({ level }, count);
+            }
+            logDropped.set({}, logs.dropped);
+        });
+    }
+
     setupMiddleware() {
         // 1. Basic middleware
         this.app.use(express.json());
@@ -741,6 +803,26 @@ this.app.get('/api/spotify/liked-songs',
     //NEW MUSIC RELATED ENDPOINTS FOR SPOTIFY INT DASHBOARD.EJS
     // Add these inside setupApiRoutes() method
 
+// Prometheus scrape endpoint: "Authorization: Bearer <METRICS_TOKEN>". Disabled unless METRICS_TOKEN is set.
+this.app.get('/api/metrics', async (req, res) => {
+    const token = process.env.METRICS_TOKEN;
+    if (!token) {
+        return res.status(404).json({ error: 'Metrics are disabled (METRICS_TOKEN is not set)', code: 404 });
+    }
+    const expected = Buffer.from(`Bearer ${token}`);
+    const given = Buffer.from(req.get('authorization') || '');
+    if (given.length !== expected.length || !crypto.timingSafeEqual(given, expected)) {
+        return res.status(401).json({ error: 'Unauthorized', code: 401 });
+    }
+    try {
+        res.set('Content-Type', metrics.CONTENT_TYPE);
+        res.send(await metrics.render());
+    } catch (error) {
+        console.error('Metrics render error:', error);
+        res.status(500).json({ error: 'Failed to render metrics', code: 500 });
+    }
+});
+
 // Status and Ping endpoints
 this.app.get('/api/status', (req, res) => {
     res.json({
@@ -857,53 +939,20 @@ this.app.post('/api/music/volume/:guildId', this.isAuthenticated.bind(this), (re
 //unused completed here
 this.app.get('/api/music/queue/:guildId', this.isAuthenticated.bind(this), (req, res) => {
     try {
-        const player = this.client.manager.players.get(req.params.guildId);
-        
-        // If no player exists, return empty queue state instead of error
-        if (!player) {
-            return res.json({
-                currentTrack: null,
-                queue: [],
-                paused: false,
-                volume: 100,
-                playing: false
-            });
-        }
-        
-        res.json({
-            currentTrack: player.queue.current ? {
-                title: player.queue.current.title,
-                author: player.queue.current.author,
-                duration: player.queue.current.duration,
-                thumbnail: player.queue.current.thumbnail,
-                uri: player.queue.current.uri,
-                requester: player.queue.current.requester
-            } : null,
-            queue: player.queue.map(track => ({
-                title: track.title,
-                author: track.author,
-                duration: track.duration,
-                thumbnail: track.thumbnail,
-                uri: track.uri,
-                requester: track.requester
-            })),
-            paused: player.paused,
-            volume: player.volume,
-            playing: player.playing
-        });
+        // If no player exists this is an empty queue state instead of an error
+        res.json(buildQueueState(this.client.manager.players.get(req.params.guildId)));
     } catch (error) {
         console.error('Queue fetch error:', error);
         // Return empty state on error instead of error response
-        res.json({
-            currentTrack: null,
-            queue: [],
-            paused: false,
-            volume: 100,
-            playing: false
-        });
+        res.json(buildQueueState(null));
     }
 });
 
+// Live queue updates: one snapshot, then diffs pushed from the Lavalink events
+this.app.get('/api/music/events/:guildId', this.isAuthenticated.bind(this), (req, res) => {
+    this.musicFeed.subscribe(req.params.guildId, req, res);
+});
+
 this.app.get('/api/music/now-playing', this.isAuthenticated.bind(this), (req, res) => {
     try {
         const players = Array.from(this.client.manager.players.values()).map(player => ({
@@ -954,57 +1003,6 @@ this.app.get('/api/spotify/playlist/:id/tracks', this.isAuthenticated.bind(this)
     }
 });
 
-//queue
-this.app.get('/api/music/queue/:guildId', this.isAuthenticated.bind(this), (req, res) => {
-    try {
-        const player = this.client.manager.players.get(req.params.guildId);
-        
-        // If no player exists, return empty queue state instead of error
-        if (!player) {
-            return res.json({
-                currentTrack: null,
-                queue: [],
-                paused: false,
-                volume: 100,
-                playing: false
-            });
-        }
-        
-        res.json({
-            currentTrack: player.queue.current ? {
-                title: player.queue.current.title,
-                author: player.queue.current.author,
-                duration: player.queue.current.duration,
-                thumbnail: player.queue.current.thumbnail,
-                uri: player.queue.current.uri,
-                requester: player.queue.current.requester
-            } : null,
-            queue: player.queue.map(track => ({
-                title: track.title,
-                author: track.author,
-                duration: track.duration,
-                thumbnail: track.thumbnail,
-                uri: track.uri,
-                requester: track.requester
-            })),
-            paused: player.paused,
-            volume: player.volume,
-            playing: player.playing
-        });
-    } catch (error) {
-        console.error('Queue fetch error:', error);
-        // Return empty state on error instead of error response
-        res.json({
-            currentTrack: null,
-            queue: [],
-            paused: false,
-            volume: 100,
-            playing: false
-        });
-    }
-});
-
-
 // playyy in dc
 this.app.post('/api/music/play', this.isAuthenticated.bind(this), async (req, res) => {
     try {
@@ -1,30 +1,17 @@
-const fs = require("fs");
 const path = require("path");
+const { openStore } = require("./jsonStore");
 
-const storagePath = path.join(__dirname, "verification_storage.json");
-
-let storage = {};
-if (fs.existsSync(storagePath)) {
-  storage = JSON.parse(fs.readFileSync(storagePath, "utf-8"));
-}
-
-function saveStorage() {
-  fs.writeFileSync(storagePath, JSON.stringify(storage, null, 2));
-}
+const storage = openStore(path.join(__dirname, "verification_storage.json"), { pretty: true });
 
 function getGuildData(guildId) {
-  if (!storage[guildId]) {
-    storage[guildId] = {
-      verificationEnabled: false,
-      accessChannelId: null, // Store the ID of the access-server channel :>
-    };
-  }
-  return storage[guildId];
+  return storage.get(guildId) || {
+    verificationEnabled: false,
+    accessChannelId: null, // Store the ID of the access-server channel :>
+  };
 }
 
 function setGuildData(guildId, data) {
-  storage[guildId] = { ...storage[guildId], ...data };
-  saveStorage();
+  storage.set(guildId, { ...getGuildData(guildId), ...data });
 }
 
 module.exports = { getGuildData, setGuildData };
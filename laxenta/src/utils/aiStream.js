@@ -0,0 +1,423 @@
+const fs = require('fs').promises;
+const fsSync = require('fs');
+const path = require('path');
+const { StringDecoder } = require('string_decoder');
+
+// Discord rejects message content over 2000 characters.
+const DISCORD_CONTENT_LIMIT = 2000;
+// Attempts at the final edit before the text is sent as a fresh reply instead.
+const FINAL_EDIT_ATTEMPTS = 3;
+
+/**
+ * Incremental parser for OpenAI-style server-sent events.
+ *
+ * Network chunks can end anywhere (mid-line, mid-JSON, mid-UTF-8 sequence), so
+ * partial lines are buffered until their newline arrives. Each complete event
+ * is handed to `onEvent` as parsed JSON; `[DONE]` calls `onDone`.
+ */
+class SSEParser {
+  constructor({ onEvent, onDone, onError } = {}) {
+    this.onEvent = onEvent || (() => {});
+    this.onDone = onDone || (() => {});
+    this.onError = onError || ((err) => console.error('SSE parse error:', err.message));
+    this.decoder = new StringDecoder('utf8');
+    this.buffer = '';
+    this.dataLines = [];
+    this.done = false;
+  }
+
+  push(chunk) {
+    this.buffer += typeof chunk === 'string' ? chunk : this.decoder.write(chunk);
+
+    let newline;
+    while ((newline = this.buffer.indexOf('\n')) !== -1) {
+      let line = this.buffer.slice(0, newline);
+      this.buffer = this.buffer.slice(newline + 1);
+      if (line.endsWith('\r')) line = line.slice(0, -1);
+      this.handleLine(line);
+    }
+  }
+
+  end() {
+    this.buffer += this.decoder.end();
+    if (this.buffer) {
+      this.handleLine(this.buffer);
+      this.buffer = '';
+    }
+    this.dispatch();
+  }
+
+  handleLine(line) {
+    // A blank line terminates an event.
+    if (line === '') {
+      this.dispatch();
+      return;
+    }
+    if (line.startsWith(':')) return; // comment / keep-alive
+    if (line.startsWith('data:')) {
+      this.dataLines.push(line.slice(line[5] === ' ' ? 6 : 5));
+    }
+  }
+
+  dispatch() {
+    if (this.dataLines.length === 0) return;
+    const payload = this.dataLines.join('\n');
+    this.dataLines = [];
+
+    if (payload === '[DONE]') {
+      if (!this.done) {
+        this.done = true;
+        this.onDone();
+      }
+      return;
+    }
+    try {
+      this.onEvent(JSON.parse(payload));
+    } catch (err) {
+      this.onError(err);
+    }
+  }
+}
+
+/**
+ * Read a chat-completions stream, calling `onToken(delta, fullText)` for every
+ * content delta. Resolves with the full text once the stream ends.
+ */
+function readCompletionStream(stream, onToken = () => {}) {
+  return new Promise((resolve, reject) => {
+    let text = '';
+    const parser = new SSEParser({
+      onEvent: (event) => {
+        const delta = event.choices?.[0]?.delta?.content ?? event.choices?.[0]?.message?.content;
+        if (!delta) return;
+        text += delta;
+        onToken(delta, text);
+      },
+    });
+
+    stream.on('data', (chunk) => parser.push(chunk));
+    stream.on('end', () => {
+      parser.end();
+      resolve(text);
+    });
+    stream.on('error', reject);
+  });
+}
+
+/**
+ * Coalesces streamed text into Discord message edits.
+ *
+ * Only one edit is ever in flight and edits are at least `minInterval` apart;
+ * tokens arriving in between just replace the pending content, so the message
+ * always converges to the newest text without overlapping or reordered edits.
+ */
+class EditScheduler {
+  constructor(sentMessage, { minInterval = 1200, formatPending = (text) => text, startedAt = Date.now() } = {}) {
+    this.message = sentMessage;
+    this.minInterval = minInterval;
+    this.formatPending = formatPending;
+    this.latest = null;
+    this.shown = null;
+    this.lastEditAt = 0;
+    this.timer = null;
+    this.inFlight = null;
+    this.closed = false;
+
+    this.startedAt = startedAt;
+    this.firstVisibleAt = null;
+    this.edits = 0;
+  }
+
+  update(text) {
+    if (this.closed) return;
+    this.latest = text;
+    this.schedule();
+  }
+
+  schedule() {
+    if (this.timer || this.inFlight) return;
+    const wait = Math.max(0, this.lastEditAt + this.minInterval - Date.now());
+    this.timer = setTimeout(() => {
+      this.timer = null;
+      this.inFlight = this.flush().finally(() => {
+        this.inFlight = null;
+        if (!this.closed && this.latest !== this.shown) this.schedule();
+      });
+    }, wait);
+  }
+
+  async flush(content = this.formatPending(this.latest), { rethrow = false } = {}) {
+    if (!content || content === this.shown) return;
+    const text = content.length > DISCORD_CONTENT_LIMIT
+      ? content.slice(0, DISCORD_CONTENT_LIMIT - 1) + '…'
+      : content;
+
+    try {
+      await this.message.edit({ content: text, allowedMentions: { repliedUser: false } });
+      this.shown = content;
+      this.edits++;
+      if (!this.firstVisibleAt) this.firstVisibleAt = Date.now();
+    } catch (err) {
+      // Back off a full interval on rate limits or transient failures.
+      const retryAfter = err.retryAfter ?? err.rawError?.retry_after * 1000;
+      this.lastEditAt = Date.now() + (Number.isFinite(retryAfter) ? retryAfter : this.minInterval);
+      console.error('Streaming edit failed:', err.message);
+      if (rethrow) throw err;
+      return;
+    }
+    this.lastEditAt = Date.now();
+  }
+
+  /**
+   * The final text has to land: retry the edit once each backoff has passed,
+   * then fall back to a fresh reply. Throws only if that reply fails too.
+   */
+  async flushFinal(content) {
+    for (let attempt = 1; attempt <= FINAL_EDIT_ATTEMPTS; attempt++) {
+      const wait = this.lastEditAt - Date.now();
+      if (wait > 0) await new Promise(res => setTimeout(res, wait));
+      try {
+        await this.flush(content, { rethrow: true });
+        return;
+      } catch {
+        // flush() already logged it and pushed lastEditAt past the backoff
+      }
+    }
+
+    await this.message.reply({
+      content: content.slice(0, DISCORD_CONTENT_LIMIT),
+      allowedMentions: { repliedUser: false }
+    });
+    this.shown = content;
+    if (!this.firstVisibleAt) this.firstVisibleAt = Date.now();
+  }
+
+  /**
+   * Stop scheduling and write the final text. Text beyond Discord's limit is
+   * sent as follow-up replies. Rejects if the text could not be delivered.
+   */
+  async finish(finalText) {
+    this.closed = true;
+    if (this.timer) {
+      clearTimeout(this.timer);
+      this.timer = null;
+    }
+    if (this.inFlight) await this.inFlight;
+
+    const chunks = splitText(finalText || '', DISCORD_CONTENT_LIMIT);
+    if (chunks.length === 0) return this.stats();
+
+    await this.flushFinal(chunks[0]);
+    for (const chunk of chunks.slice(1)) {
+      await this.message.reply({ content: chunk, allowedMentions: { repliedUser: false } });
+    }
+    return this.stats();
+  }
+
+  stats() {
+    return {
+      timeToFirstVisibleToken: this.firstVisibleAt ? this.firstVisibleAt - this.startedAt : null,
+      edits: this.edits,
+    };
+  }
+}
+
+/**
+ * Split text into pieces of at most `max` characters.
+ */
+function splitText(text, max = DISCORD_CONTENT_LIMIT) {
+  const chunks = [];
+  for (let i = 0; i < text.length; i += max) {
+    chunks.push(text.slice(i, i + max));
+  }
+  return chunks;
+}
+
+/**
+ * Per-user conversation history with a TTL/size-bounded LRU in front of disk.
+ *
+ * Each exchange is appended as one JSON line to `<prefix><userId>.jsonl`; the
+ * file is compacted (atomically) once it holds several times the history
+ * limit. Legacy `<prefix><userId>.json` pair arrays are still read.
+ */
+class HistoryStore {
+  /**
+   * @param {object} options
+   * @param {string} options.dir directory for history files
+   * @param {string} [options.filePrefix] file name prefix, e.g. 'memory_'
+   * @param {string} [options.replyRole] role used for bot replies ('assistant' or 'system')
+   * @param {number} [options.limit] messages kept per user (user + reply count separately)
+   * @param {number} [options.ttl] evict idle users from memory after this long (ms)
+   * @param {number} [options.maxUsers] max users held in memory
+   */
+  constructor({ dir, filePrefix = 'memory_', replyRole = 'assistant', limit = 10, ttl = 1000 * 60 * 10, maxUsers = 500 }) {
+    this.dir = dir;
+    this.filePrefix = filePrefix;
+    this.replyRole = replyRole;
+    this.limit = limit;
+    this.ttl = ttl;
+    this.maxUsers = maxUsers;
+    this.cache = new Map(); // userId -> { memory, lines, expiresAt }, oldest first
+    this.writes = new Map(); // userId -> pending write chain
+
+    if (!fsSync.existsSync(dir)) {
+      fsSync.mkdirSync(dir, { recursive: true });
+    }
+  }
+
+  filePath(userId, ext = 'jsonl') {
+    return path.join(this.dir, `${this.filePrefix}${userId}.${ext}`);
+  }
+
+  pairToMessages(pair) {
+    return [
+      {
+        role: 'user',
+        content: pair.user.includes(':') ? pair.user : `unknown_user: ${pair.user}` // Preserve username if exists
+      },
+      { role: this.replyRole, content: pair[this.replyRole] ?? pair.assistant ?? pair.system ?? '' }
+    ];
+  }
+
+  async readPairs(userId) {
+    let pairs = [];
+    try {
+      pairs = JSON.parse(await fs.readFile(this.filePath(userId, 'json'), 'utf8'));
+    } catch {
+      // No legacy history
+    }
+    try {
+      const lines = (await fs.readFile(this.filePath(userId), 'utf8')).split('\n');
+      for (const line of lines) {
+        if (!line) continue;
+        try {
+          pairs.push(JSON.parse(line));
+        } catch {
+          // Torn last line from a crash
+        }
+      }
+    } catch {
+      // No appended history yet
+    }
+    return pairs;
+  }
+
+  async get(userId) {
+    const entry = this.cache.get(userId);
+    if (entry && entry.expiresAt > Date.now()) {
+      this.touch(userId, entry);
+      return entry.memory;
+    }
+
+    // An evicted user may still have an append or compaction queued; read after it lands.
+    await this.writes.get(userId);
+    const pairs = await this.readPairs(userId);
+    const memory = pairs.flatMap((pair) => this.pairToMessages(pair)).slice(-this.limit);
+    this.touch(userId, { memory, lines: pairs.length });
+    return memory;
+  }
+
+  touch(userId, entry) {
+    this.cache.delete(userId);
+    entry.expiresAt = Date.now() + this.ttl;
+    this.cache.set(userId, entry);
+    this.evict();
+  }
+
+  evict() {
+    const now = Date.now();
+    for (const [userId, entry] of this.cache) {
+      if (this.cache.size <= this.maxUsers && entry.expiresAt > now) break;
+      this.cache.delete(userId);
+    }
+  }
+
+  /**
+   * Record one exchange and append it to disk.
+   */
+  async append(userId, userContent, replyContent) {
+    await this.get(userId);
+    const entry = this.cache.get(userId) || { memory: [], lines: 0 };
+    entry.memory = [
+      ...entry.memory,
+      { role: 'user', content: userContent },
+      { role: this.replyRole, content: replyContent }
+    ].slice(-this.limit);
+    entry.lines++;
+    this.touch(userId, entry);
+
+    const line = JSON.stringify({ user: userContent, [this.replyRole]: replyContent }) + '\n';
+    const compact = entry.lines > this.limit * 4;
+    if (compact) entry.lines = Math.ceil(this.limit / 2);
+    const memory = entry.memory;
+
+    // Serialise writes per user so appends and compactions never interleave.
+    const previous = this.writes.get(userId) || Promise.resolve();
+    const next = previous.then(() => (compact ? this.compact(userId, memory) : fs.appendFile(this.filePath(userId), line)))
+      .catch((err) => console.error(`Failed to save history for ${userId}:`, err.message))
+      .finally(() => {
+        if (this.writes.get(userId) === next) this.writes.delete(userId);
+      });
+    this.writes.set(userId, next);
+    return next;
+  }
+
+  async compact(userId, memory) {
+    let body = '';
+    for (let i = 0; i + 1 < memory.length; i += 2) {
+      body += JSON.stringify({ user: memory[i].content, [this.replyRole]: memory[i + 1].content }) + '\n';
+    }
+    const target = this.filePath(userId);
+    await fs.writeFile(`${target}.tmp`, body, 'utf8');
+    await fs.rename(`${target}.tmp`, target);
+    await fs.unlink(this.filePath(userId, 'json')).catch(() => {});
+  }
+
+  async delete(userId) {
+    this.cache.delete(userId);
+    await this.writes.get(userId); // so a queued append can't recreate the file
+    await Promise.all([
+      fs.unlink(this.filePath(userId)).catch(() => {}),
+      fs.unlink(this.filePath(userId, 'json')).catch(() => {})
+    ]);
+  }
+}
+
+/**
+ * Aggregate reply timings for a processor (time-to-first-visible-token, edits).
+ */
+class StreamStats {
+  constructor() {
+    this.replies = 0;
+    this.totalEdits = 0;
+    this.totalFirstToken = 0;
+    this.firstTokenSamples = 0;
+  }
+
+  record({ timeToFirstVisibleToken, edits }) {
+    this.replies++;
+    this.totalEdits += edits;
+    if (timeToFirstVisibleToken !== null) {
+      this.totalFirstToken += timeToFirstVisibleToken;
+      this.firstTokenSamples++;
+    }
+  }
+
+  toJSON() {
+    return {
+      replies: this.replies,
+      avgEditsPerReply: this.replies ? this.totalEdits / this.replies : 0,
+      avgTimeToFirstVisibleTokenMs: this.firstTokenSamples ? this.totalFirstToken / this.firstTokenSamples : null
+    };
+  }
+}
+
+module.exports = {
+  DISCORD_CONTENT_LIMIT,
+  SSEParser,
+  readCompletionStream,
+  EditScheduler,
+  HistoryStore,
+  StreamStats,
+  splitText
+};
@@ -1,35 +1,37 @@
 const { Collection, EmbedBuilder, PermissionsBitField, ChannelType } = require('discord.js');
-const fs = require('fs');
 const path = require('path');
+const { openStore } = require('./jsonStore');
+const { SpamTracker } = require('./spamTracker');
 
 const STORAGE_PATH = path.resolve(__dirname, '../storage.json');
 const messageLimit = 5;
 const timeFrame = 10000; // 10 seconds
 const muteDuration = 60000; // 60 seconds
+const MAX_MESSAGE_LIMIT = 20; // upper bound for per-guild messageLimit (sizes the ring)
+const MAX_TIME_FRAME = 60000; // upper bound for per-guild timeFrame (users idle this long are evicted)
 
 const defaultSettings = {
   autoModEnabled: true,
   antiSpamEnabled: true,
 };
 
-const messageLog = new Collection();
+const storage = openStore(STORAGE_PATH);
+
+const tracker = new SpamTracker({ maxLimit: MAX_MESSAGE_LIMIT, idleTimeout: MAX_TIME_FRAME });
 const mutedUsers = new Collection();
 
 /**
- * Utility function to read storage data.
+ * Utility function to read storage data (served from memory).
  */
 function readStorage() {
-  if (!fs.existsSync(STORAGE_PATH)) {
-    fs.writeFileSync(STORAGE_PATH, JSON.stringify({}), 'utf8');
-  }
-  return JSON.parse(fs.readFileSync(STORAGE_PATH, 'utf8'));
+  return storage.all();
 }
 
 /**
- * Utility function to write storage data.
+ * Utility function to write storage data (flushed to disk in the background).
  */
 function writeStorage(data) {
-  fs.writeFileSync(STORAGE_PATH, JSON.stringify(data), 'utf8');
+  storage.replace(data);
 }
 
 /**
@@ -38,12 +40,7 @@ function writeStorage(data) {
  * @returns {object}
  */
 function getGuildSettings(guildId) {
-  const data = readStorage();
-  if (!data[guildId]) {
-    data[guildId] = { ...defaultSettings };
-    writeStorage(data);
-  }
-  return data[guildId];
+  return storage.get(guildId) || { ...defaultSettings };
 }
 
 /**
@@ -52,9 +49,7 @@ function getGuildSettings(guildId) {
  * @param {object} settings
  */
 function setGuildSettings(guildId, settings) {
-  const data = readStorage();
-  data[guildId] = settings;
-  writeStorage(data);
+  storage.set(guildId, settings);
 }
 
 /**
@@ -77,29 +72,61 @@ function isAntiSpamEnabled(guildId) {
   return settings.antiSpamEnabled;
 }
 
-function checkForSpam(message) {
-  if (!isAntiSpamEnabled(message.guild.id) || message.author.bot) return;
+/**
+ * Spam thresholds for a guild. Guild settings may override
+ * messageLimit, timeFrame and muteDuration.
+ * @param {object} settings
+ */
+function getSpamThresholds(settings) {
+  return {
+    limit: Math.min(settings.messageLimit || messageLimit, MAX_MESSAGE_LIMIT),
+    timeFrame: Math.min(settings.timeFrame || timeFrame, MAX_TIME_FRAME),
+    muteDuration: settings.muteDuration || muteDuration,
+  };
+}
 
-  const userMessages = messageLog.get(message.author.id) || [];
-  const currentTime = Date.now();
+function checkForSpam(message) {
+  if (message.author.bot) return;
+  const guildId = message.guild.id;
+  const settings = getGuildSettings(guildId);
+  if (!settings.antiSpamEnabled) return;
 
-  userMessages.push({ timestamp: currentTime, message });
-  messageLog.set(message.author.id, userMessages);
+  const thresholds = getSpamThresholds(settings);
+  const overLimit = tracker.record(guildId, message.author.id, message.channel.id, message.id, thresholds);
 
-  const recentMessages = userMessages.filter(
-    (msg) => currentTime - msg.timestamp <= timeFrame
-  );
-  messageLog.set(message.author.id, recentMessages);
+  if (overLimit && !mutedUsers.has(`${guildId}:${message.author.id}`)) {
+    spamDetected(message, thresholds);
+  }
+}
 
-  if (recentMessages.length > messageLimit) {
-    if (!mutedUsers.has(message.author.id)) {
-      spamDetected(message.author.id, recentMessages);
+/**
+ * Delete the given messages, using one bulkDelete per channel.
+ * @param {import('discord.js').Guild} guild
+ * @param {Map<string, string[]>} byChannel channelId -> message ids
+ */
+async function deleteMessages(guild, byChannel) {
+  await Promise.all([...byChannel].map(async ([channelId, messageIds]) => {
+    const channel = guild.channels.cache.get(channelId);
+    if (!channel) return;
+    try {
+      if (messageIds.length === 1) {
+        await channel.messages.delete(messageIds[0]);
+      } else {
+        // bulkDelete accepts at most 100 ids per call
+        for (let i = 0; i < messageIds.length; i += 100) {
+          await channel.bulkDelete(messageIds.slice(i, i + 100), true);
+        }
+      }
+    } catch (error) {
+      console.error('Error deleting spam messages:', error);
     }
-  }
+  }));
 }
 
-async function spamDetected(userId, recentMessages) {
-  const guild = recentMessages[0].message.guild;
+async function spamDetected(message, thresholds) {
+  const guild = message.guild;
+  const userId = message.author.id;
+  const muteKey = `${guild.id}:${userId}`;
   const member = guild.members.resolve(userId);
   const botMember = guild.members.resolve(guild.client.user.id); // Bot's member info
 
@@ -117,17 +144,13 @@ async function spamDetected(userId, recentMessages) {
     return;
   }
 
+  // Mark as muted up front so messages arriving mid-timeout don't trigger again
+  mutedUsers.set(muteKey, Date.now());
+
   try {
-    await member.timeout(muteDuration, 'Spamming messages');
-    mutedUsers.set(userId, Date.now());
+    await member.timeout(thresholds.muteDuration, 'Spamming messages');
 
-    for (const msgObj of recentMessages) {
-      try {
-        await msgObj.message.delete();
-      } catch (error) {
-        console.error('Error deleting spam message:', error);
-      }
-    }
+    await deleteMessages(guild, tracker.drain(guild.id, userId, thresholds.timeFrame));
 
     const embed = new EmbedBuilder()
       .setColor('#ff0000')
@@ -135,13 +158,13 @@ async function spamDetected(userId, recentMessages) {
       .setDescription(`<@${userId}> has been timed out for spamming :clock:`)
       .setTimestamp();
 
-    const notification = await recentMessages[0].message.channel.send({
+    const notification = await message.channel.send({
       embeds: [embed],
     });
-    setTimeout(() => notification.delete(), 10000);
+    setTimeout(() => notification.delete().catch(() => {}), 10000);
 
     setTimeout(async () => {
-      mutedUsers.delete(userId);
+      mutedUsers.delete(muteKey);
 
       const unmuteEmbed = new EmbedBuilder()
         .setColor('#00ff00')
@@ -149,12 +172,17 @@ async function spamDetected(userId, recentMessages) {
       .setDescription(`Timeout on <@${userId}> has been removed! Please make sure to not spam again <:sparkles:1296717153827033119>`)
         .setTimestamp();
 
-      const unmuteNotification = await recentMessages[0].message.channel.send({
-        embeds: [unmuteEmbed],
-      });
-      setTimeout(() => unmuteNotification.delete(), 10000);
-    }, muteDuration);
+      try {
+        const unmuteNotification = await message.channel.send({
+          embeds: [unmuteEmbed],
+        });
+        setTimeout(() => unmuteNotification.delete().catch(() => {}), 10000);
+      } catch (error) {
+        console.error('Error sending unmute notification:', error);
+      }
+    }, thresholds.muteDuration);
   } catch (error) {
+    mutedUsers.delete(muteKey);
     console.error('Error timing out the user:', error);
   }
 }
@@ -164,6 +192,7 @@ module.exports = {
   isAutoModEnabled,
   isAntiSpamEnabled,
   getGuildSettings,
+  getSpamThresholds,
   setGuildSettings,
   readStorage,
   writeStorage,
@@ -0,0 +1,327 @@
+const { EmbedBuilder } = require('discord.js');
+const cron = require('node-cron');
+const { Birthday, BirthdayDelivery, onBirthdayChange } = require('../models/Birthday');
+
+const DEFAULT_TIMEZONE = process.env.BIRTHDAY_TIMEZONE || Intl.DateTimeFormat().resolvedOptions().timeZone;
+const CONCURRENCY = 5;
+const MAX_ATTEMPTS = 3;
+const BASE_RETRY_DELAY = 2000;
+// A pending claim older than this belongs to a run that died before sending; it may be taken over.
+const CLAIM_LEASE_MS = 60 * 60 * 1000;
+
+// Discord errors that retrying will never fix.
+const PERMANENT_ERROR_CODES = new Set([
+  10013, // Unknown user
+  50007, // Cannot send messages to this user (DMs closed)
+]);
+
+const stats = {
+  runs: 0,
+  sent: 0,
+  failed: 0,
+  skipped: 0,
+  lastRun: null,
+};
+
+// The day's candidate list, built once per UTC date and rebuilt after any
+// birthday is set, removed or (un)followed.
+let dayCache = { key: null, birthdays: [] };
+let dayCacheGeneration = 0;
+let running = false;
+
+onBirthdayChange(() => {
+  dayCacheGeneration++;
+  dayCache = { key: null, birthdays: [] };
+});
+
+// ---- Dates & timezones -----------------------------------------------------
+
+function isValidTimezone(timezone) {
+  // Intl treats a missing timeZone as the host zone, so it would pass the check below.
+  if (!timezone) return false;
+  try {
+    new Intl.DateTimeFormat('en-US', { timeZone: timezone });
+    return true;
+  } catch {
+    return false;
+  }
+}
+
+/**
+ * Calendar date (year, month, day) at `date` in the given timezone.
+ */
+function localDate(date, timezone) {
+  const parts = new Intl.DateTimeFormat('en-US', {
+    timeZone: isValidTimezone(timezone) ? timezone : DEFAULT_TIMEZONE,
+    year: 'numeric',
+    month: 'numeric',
+    day: 'numeric'
+  }).formatToParts(date);
+  const get = (type) => Number(parts.find(p => p.type === type).value);
+  return { year: get('year'), month: get('month'), day: get('day') };
+}
+
+function isBirthdayNow(birthday, now = new Date()) {
+  const today = localDate(now, birthday.timezone);
+  return today.month === birthday.month && today.day === birthday.day;
+}
+
+/**
+ * Birthdays that could be "today" somewhere on Earth (UTC date ±1 day).
+ * Queried once per UTC day (or after a change); hourly runs filter it by each user's timezone.
+ */
+async function getCandidates(now) {
+  const key = now.toISOString().slice(0, 10);
+  if (dayCache.key === key) return dayCache.birthdays;
+
+  const dates = [-1, 0, 1].map(offset => {
+    const d = new Date(now.getTime() + offset * 86400000);
+    return { month: d.getUTCMonth() + 1, day: d.getUTCDate() };
+  });
+  const generation = dayCacheGeneration;
+  const birthdays = await Birthday.find({ $or: dates }).lean();
+  // Don't cache a result that a concurrent write has already made stale.
+  if (generation === dayCacheGeneration) dayCache = { key, birthdays };
+  return birthdays;
+}
+
+function formatBirthDate(day, month, year) {
+  const monthName = new Date(Date.UTC(2024, month - 1, 1)).toLocaleString('en-US', { month: 'long', timeZone: 'UTC' });
+  return `${monthName} ${day}${year ? `, ${year}` : ''}`;
+}
+
+// ---- Embeds ----------------------------------------------------------------
+
+function buildBirthdayEmbed(username) {
+  return new EmbedBuilder()
+    .setColor('#FF69B4')
+    .setTitle('🎂 Happy Birthday!')
+    .setDescription(`Hey ${username}, it's your birthday today! Enjoy your day and some cake! 🍰`)
+    .setImage('https://i.pinimg.com/originals/57/e3/c8/57e3c8a764413d509584fc526825b980.gif')
+    .setTimestamp();
+}
+
+function buildFollowEmbed(birthdayUser, avatarUrl) {
+  return new EmbedBuilder()
+    .setColor('#00FFFF')
+    .setTitle('🔔 Birthday Notification')
+    .setDescription(`**${birthdayUser.username}'s** birthday is today!`)
+    .setThumbnail(avatarUrl || null)
+    .addFields(
+      { name: 'Birth Date', value: formatBirthDate(birthdayUser.day, birthdayUser.month, birthdayUser.year), inline: true },
+      { name: 'Birthday User', value: `<@${birthdayUser.userId}>`, inline: true }
+    )
+    .setTimestamp();
+}
+
+// ---- Bounded-concurrency send queue ----------------------------------------
+
+/**
+ * Runs DM jobs with at most `concurrency` in flight. Rate limits pause the
+ * whole queue for the advertised retry-after; other transient failures are
+ * retried with exponential backoff.
+ */
+class DispatchQueue {
+  constructor({ concurrency = CONCURRENCY, maxAttempts = MAX_ATTEMPTS, baseDelay = BASE_RETRY_DELAY } = {}) {
+    this.concurrency = concurrency;
+    this.maxAttempts = maxAttempts;
+    this.baseDelay = baseDelay;
+    this.active = 0;
+    this.waiting = [];
+    this.pausedUntil = 0;
+  }
+
+  push(job) {
+    return new Promise((resolve) => {
+      this.waiting.push({ job, resolve });
+      this.next();
+    });
+  }
+
+  next() {
+    while (this.active < this.concurrency && this.waiting.length > 0) {
+      const { job, resolve } = this.waiting.shift();
+      this.active++;
+      this.run(job).then(resolve).finally(() => {
+        this.active--;
+        this.next();
+      });
+    }
+  }
+
+  async run(job) {
+    for (let attempt = 1; ; attempt++) {
+      const pause = this.pausedUntil - Date.now();
+      if (pause > 0) await sleep(pause);
+
+      try {
+        await job();
+        return { ok: true, attempts: attempt };
+      } catch (error) {
+        const permanent = PERMANENT_ERROR_CODES.has(error.code);
+        if (permanent || attempt >= this.maxAttempts) {
+          return { ok: false, permanent, attempts: attempt, error };
+        }
+
+        const retryAfter = error.status === 429
+          ? (error.retryAfter ?? (error.rawError?.retry_after ?? 1) * 1000)
+          : null;
+        if (retryAfter !== null) {
+          this.pausedUntil = Math.max(this.pausedUntil, Date.now() + retryAfter);
+        } else {
+          await sleep(this.baseDelay * 2 ** (attempt - 1));
+        }
+      }
+    }
+  }
+}
+
+const sleep = (ms) => new Promise(res => setTimeout(res, ms));
+
+// ---- Delivery --------------------------------------------------------------
+
+/**
+ * Claim a greeting for this birthday year. Only one caller wins the claim, so
+ * overlapping runs never both send. A claim still pending after
+ * CLAIM_LEASE_MS (the process died mid-send) can be taken over by a later run.
+ */
+async function claim(birthdayUserId, year, recipientId, kind) {
+  const now = new Date();
+  try {
+    // Inserts a fresh claim, or takes over a stale one; a live or finished record
+    // matches neither and the upsert hits the unique index instead.
+    const result = await BirthdayDelivery.updateOne(
+      { birthdayUserId, year, recipientId, status: 'pending', claimedAt: { $lt: new Date(now.getTime() - CLAIM_LEASE_MS) } },
+      { $set: { kind, claimedAt: now } },
+      { upsert: true }
+    );
+    return result.upsertedCount === 1 || result.modifiedCount === 1;
+  } catch (error) {
+    if (error.code === 11000) return false;
+    throw error;
+  }
+}
+
+async function deliver(queue, key, kind, send) {
+  if (!await claim(key.birthdayUserId, key.year, key.recipientId, kind)) {
+    stats.skipped++;
+    return 'skipped';
+  }
+
+  const result = await queue.push(send);
+  if (result.ok) {
+    stats.sent++;
+    await BirthdayDelivery.updateOne(key, { $set: { status: 'sent', deliveredAt: new Date(), attempts: result.attempts } });
+    return 'sent';
+  }
+
+  stats.failed++;
+  if (result.permanent) {
+    await BirthdayDelivery.updateOne(key, { $set: { status: 'failed', attempts: result.attempts, error: result.error.message } });
+  } else {
+    // Release the claim so the next hourly run can try again.
+    await BirthdayDelivery.deleteOne(key);
+  }
+  console.error(`Birthday ${kind} DM to ${key.recipientId} failed:`, result.error.message);
+  return 'failed';
+}
+
+function greetingJobs(client, queue, birthday, now) {
+  const { year } = localDate(now, birthday.timezone);
+  const jobs = [];
+
+  jobs.push(deliver(queue, { birthdayUserId: birthday.userId, year, recipientId: birthday.userId }, 'self', async () => {
+    const user = await client.users.fetch(birthday.userId);
+    await user.send({ embeds: [buildBirthdayEmbed(birthday.username)] });
+  }));
+
+  let avatarUrl;
+  const getAvatarUrl = async () => {
+    if (avatarUrl === undefined) {
+      const user = await client.users.fetch(birthday.userId).catch(() => null);
+      avatarUrl = user ? user.displayAvatarURL({ dynamic: true }) : null;
+    }
+    return avatarUrl;
+  };
+
+  for (const follower of birthday.followers || []) {
+    jobs.push(deliver(queue, { birthdayUserId: birthday.userId, year, recipientId: follower.userId }, 'follower', async () => {
+      const user = await client.users.fetch(follower.userId);
+      await user.send({ embeds: [buildFollowEmbed(birthday, await getAvatarUrl())] });
+    }));
+  }
+  return jobs;
+}
+
+/**
+ * One dispatch pass: greet everyone whose birthday it currently is in their
+ * timezone and who hasn't been greeted this year.
+ */
+async function runBirthdayDispatch(client, now = new Date()) {
+  if (running) {
+    console.log('🎂 Birthday dispatch still running, skipping this tick');
+    return null;
+  }
+  running = true;
+  const startedAt = Date.now();
+  const before = { sent: stats.sent, failed: stats.failed, skipped: stats.skipped };
+
+  try {
+    const candidates = await getCandidates(now);
+    const due = candidates.filter(b => isBirthdayNow(b, now));
+    const queue = new DispatchQueue();
+
+    await Promise.all(due.flatMap(birthday => greetingJobs(client, queue, birthday, now)));
+
+    stats.runs++;
+    stats.lastRun = {
+      startedAt: new Date(startedAt).toISOString(),
+      durationMs: Date.now() - startedAt,
+      birthdays: due.length,
+      sent: stats.sent - before.sent,
+      failed: stats.failed - before.failed,
+      skipped: stats.skipped - before.skipped,
+    };
+    if (due.length > 0) {
+      console.log(`🎂 Birthday dispatch: ${JSON.stringify(stats.lastRun)}`);
+    }
+    return stats.lastRun;
+  } finally {
+    running = false;
+  }
+}
+
+/**
+ * Greet a user right away if their birthday is today (e.g. just after /birthday set).
+ */
+async function greetIfBirthday(client, birthday, now = new Date()) {
+  if (!isBirthdayNow(birthday, now)) return null;
+  const { year } = localDate(now, birthday.timezone);
+  return deliver(new DispatchQueue({ concurrency: 1 }), { birthdayUserId: birthday.userId, year, recipientId: birthday.userId }, 'self', async () => {
+    const user = await client.users.fetch(birthday.userId);
+    await user.send({ embeds: [buildBirthdayEmbed(birthday.username)] });
+  });
+}
+
+// Birthday checker (runs every hour so every timezone gets its greeting on time)
+function setupBirthdayDispatcher(client) {
+  cron.schedule('0 * * * *', () => {
+    runBirthdayDispatch(client).catch(error => console.error('Birthday dispatch error:', error));
+  });
+  console.log('🕒 Birthday dispatcher scheduled (every hour)!');
+}
+
+function getBirthdayDispatchStats() {
+  return { ...stats, running };
+}
+
+module.exports = {
+  setupBirthdayDispatcher,
+  runBirthdayDispatch,
+  greetIfBirthday,
+  getBirthdayDispatchStats,
+  buildBirthdayEmbed,
+  buildFollowEmbed,
+  isValidTimezone,
+  DispatchQueue,
+};
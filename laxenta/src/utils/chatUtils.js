@@ -1,7 +1,6 @@
 const axios = require('axios');
-const fs = require('fs').promises;
-const fsSync = require('fs');
 const path = require('path');
+const { readCompletionStream, EditScheduler, HistoryStore, StreamStats } = require('./aiStream');
 
 const API_KEY = process.env.APEXIFY_API_KEY || 'ek-3gmOPmvuljmrl4NQrohpnp1ryNXQG5bNn08zNuzhX6bcxBrndR';
 
@@ -34,69 +33,23 @@ RP Style:
 Dont use **italics** in what she says, use *italics* for actions and thoughts ONLY-
 example response (improvise): *she gets up from her balcony, and is staring downhill thinking of taking a shower* nice morning... oh whats the time... fuck..`    };
 
-    this.historyDir = path.join(__dirname, "AiHistory");
-    if (!fsSync.existsSync(this.historyDir)) {
-      fsSync.mkdirSync(this.historyDir);
-    }
-
-    this.memoryCache = new Map();
-    this.CACHE_DURATION = 1000 * 60 * 10; // 30 minutes
+    this.CACHE_DURATION = 1000 * 60 * 10; // 10 minutes
+
+    // History lives in an LRU (idle users expire after CACHE_DURATION) and is appended to AiHistory/
+    this.history = new HistoryStore({
+      dir: path.join(__dirname, "AiHistory"),
+      filePrefix: 'memory_',
+      replyRole: 'system',
+      limit: this.config.limit,
+      ttl: this.CACHE_DURATION
+    });
+    this.stats = new StreamStats();
   }
 
   getRequestKey(channelId, userId) {
     return `${channelId}-${userId}`;
   }
 
-  // Memory file will be stored inside the AiHistory folder.
-  getMemoryFilePath(userId) {
-    return path.join(this.historyDir, `memory_${userId}.json`);
-  }
-
-  async loadMemory(userId) {
-    if (this.memoryCache.has(userId)) {
-      return this.memoryCache.get(userId);
-    }
-
-    const filePath = this.getMemoryFilePath(userId);
-    try {
-      const data = await fs.readFile(filePath, 'utf8');
-      const pairs = JSON.parse(data);
-      // Convert pairs back to array format with correct roles
-      const memory = pairs.flatMap(pair => [
-        { 
-          role: "user", 
-          content: pair.user.includes(":") ? pair.user : `unknown_user: ${pair.user}` // Preserve username if exists
-        },
-        { 
-          role: "system", 
-          content: pair.system 
-        }
-      ]);
-      this.memoryCache.set(userId, memory);
-      return memory;
-    } catch (err) {
-      const empty = [];
-      this.memoryCache.set(userId, empty);
-      return empty;
-    }
-  }
-
-  async saveMemory(userId, memory) {
-    // Format memory as conversation pairs but maintain system/user roles
-    const formattedMemory = [];
-    for (let i = 0; i < memory.length; i += 2) {
-      if (i + 1 < memory.length) {
-        formattedMemory.push({
-          user: memory[i].content,
-          system: memory[i + 1].content  // Changed from assistant to system
-        });
-      }
-    }
-    
-    const filePath = this.getMemoryFilePath(userId);
-    await fs.writeFile(filePath, JSON.stringify(formattedMemory, null, 2), 'utf8');
-  }
-
   startTyping(channel, key) {
     if (this.typingSessions.has(key)) return;
     const sendTyping = () => channel.sendTyping().catch(() => {});
@@ -118,15 +71,6 @@ example response (improvise): *she gets up from her balcony, and is staring down
     }
   }
 
-  // Helper to split text into chunks of maxLength (2000 characters)
-  splitText(text, max = this.config.maxLength) {
-    const chunks = [];
-    for (let i = 0; i < text.length; i += max) {
-      chunks.push(text.slice(i, i + max));
-    }
-    return chunks;
-  }
-
   // Helper function to call the API with retries (2 retries)
   async apiCallWithRetries(url, payload, axiosConfig, retries = 2) {
     let attempt = 0;
@@ -156,6 +100,7 @@ example response (improvise): *she gets up from her balcony, and is staring down
   }
 
   async processMessage(message) {
+    const receivedAt = Date.now();
     const key = this.getRequestKey(message.channel.id, message.author.id);
     if (this.activeRequests.has(key)) return;
     this.activeRequests.set(key, true);
@@ -174,7 +119,7 @@ example response (improvise): *she gets up from her balcony, and is staring down
 
       if (!query) return;
 
-      let memory = await this.loadMemory(message.author.id);
+      const memory = await this.history.get(message.author.id);
       
       // Format user's message with proper role and include username
       const formattedQuery = {
@@ -210,80 +155,27 @@ example response (improvise): *she gets up from her balcony, and is staring down
         }
       );
 
-      let sentMessage = await message.reply({ 
+      const sentMessage = await message.reply({ 
         content: '<a:loading:1376058398403199060> *she is thinking...*',
         allowedMentions: { repliedUser: false }
       });
 
-      let accumulatedResponse = '';
-      let lastUpdate = Date.now();
-      let updateBuffer = '';
-      const minUpdateLength = 100; // Increased to 100 characters
-      const updateDelay = 1000; // Minimum 3 seconds between updates
-      const stream = response.data;
-
-      stream.on('data', async chunk => {
-        try {
-          const lines = chunk.toString().split('\n');
-          for (const line of lines) {
-            if (line.startsWith('data: ')) {
-              const jsonStr = line.slice(6);
-              if (jsonStr === '[DONE]') continue;
-              
-              const data = JSON.parse(jsonStr);
-              if (!data.choices?.[0]?.delta?.content) continue;
-
-              const newContent = data.choices[0].delta.content;
-              accumulatedResponse += newContent;
-              updateBuffer += newContent;
-              
-              // Only update if:
-              // 1. Buffer is large enough (500+ chars)
-              // 2. Enough time has passed (3+ seconds)
-              // 3. Buffer ends with sentence-ending character or space
-              if (updateBuffer.length >= minUpdateLength && 
-                  Date.now() - lastUpdate > updateDelay &&
-                  /[.!?]\s*$|\s$/.test(updateBuffer)) {
-                
-                await sentMessage.edit({
-                  content: accumulatedResponse,
-                  allowedMentions: { repliedUser: false }
-                });
-                updateBuffer = '';
-                lastUpdate = Date.now();
-              }
-            }
-          }
-        } catch (e) {
-          console.error('Streaming error:', e.message);
-        }
-      });
+      // One scheduler per reply: tokens are coalesced and edits never overlap.
+      const editor = new EditScheduler(sentMessage, { minInterval: 1200, startedAt: receivedAt });
+      const accumulatedResponse = await readCompletionStream(response.data, (delta, text) => editor.update(text));
 
-      await new Promise((resolve, reject) => {
-        stream.on('end', resolve);
-        stream.on('error', reject);
-      });
+      // Nothing streamed: drop the placeholder and let the catch below reply, keeping history clean
+      if (!accumulatedResponse) {
+        await editor.finish('');
+        await sentMessage.delete().catch(() => {});
+        throw new Error('Empty API response');
+      }
 
       // Final update with complete response
-      await sentMessage.edit({
-        content: accumulatedResponse,
-        allowedMentions: { repliedUser: false }
-      });
+      this.stats.record(await editor.finish(accumulatedResponse));
 
       // Store memory with correct roles
-      memory.push({
-        role: "user",
-        content: `${message.author.username}: ${query}`
-      });
-      memory.push({
-        role: "system",
-        content: accumulatedResponse
-      });
-      
-      if (memory.length > this.config.limit) {
-        memory = memory.slice(-this.config.limit);
-      }
-      await this.saveMemory(message.author.id, memory);
+      await this.history.append(message.author.id, formattedQuery.content, accumulatedResponse);
 
     } catch (error) {
       console.error('Error:', error.message);
@@ -298,4 +190,5 @@ example response (improvise): *she gets up from her balcony, and is staring down
 }
 
 const processor = new MessageProcessor();
-module.exports.handleChat = (message) => processor.processMessage(message);
\ No newline at end of file
+module.exports.handleChat = (message) => processor.processMessage(message);
+module.exports.getStreamStats = () => processor.stats.toJSON();
\ No newline at end of file
@@ -1,88 +1,338 @@
 // path: utils/economyUtil.js
 
-const { MongoClient } = require('mongodb');
+const mongoose = require('mongoose');
 
 const uri = process.env.MONGO_URI;
 if (!uri) {
   throw new Error("MONGO_URI not found in environment variables.");
 }
 
-const client = new MongoClient(uri, { useNewUrlParser: true, useUnifiedTopology: true });
-let db = null;
-
 // The default starting balance for new users.
 const DEFAULT_BALANCE = 1000000;
+const DB_NAME = process.env.ECONOMY_DB || "botEconomy";
+
+let collection = null;
+let connecting = null;
 
 /**
- * Connects to MongoDB and returns the database object.
+ * Returns the economy users collection, sharing the bot's mongoose connection.
  */
 async function connectDB() {
-  if (db) return db;
-  try {
-    await client.connect();
-    db = client.db("botEconomy");
+  if (collection) return collection;
+  if (connecting) return connecting;
+
+  connecting = (async () => {
+    if (mongoose.connection.readyState === 0) {
+      await mongoose.connect(uri, { monitorCommands: true });
+    } else {
+      await mongoose.connection.asPromise();
+    }
+    const users = mongoose.connection.getClient().db(DB_NAME).collection("users");
+    await ensureIndexes(users);
     console.log("Connected to MongoDB for economy management.");
-    return db;
+    collection = users;
+    return users;
+  })();
+
+  try {
+    return await connecting;
   } catch (error) {
     console.error("Error connecting to MongoDB:", error);
     throw error;
+  } finally {
+    connecting = null;
+  }
+}
+
+/**
+ * Keep the oldest document for each userId and delete the rest. Older builds
+ * could insert the same user twice, which blocks the unique index.
+ */
+async function removeDuplicateUsers(users) {
+  const duplicates = await users.aggregate([
+    { $sort: { _id: 1 } },
+    { $group: { _id: "$userId", keep: { $first: "$_id" }, ids: { $push: "$_id" }, count: { $sum: 1 } } },
+    { $match: { count: { $gt: 1 } } },
+  ]).toArray();
+
+  let removed = 0;
+  for (const { keep, ids } of duplicates) {
+    const { deletedCount } = await users.deleteMany({ _id: { $in: ids.filter(id => !id.equals(keep)) } });
+    removed += deletedCount;
+  }
+  return removed;
+}
+
+/**
+ * Build the economy indexes. A failure here is logged rather than thrown so
+ * the economy keeps working (unindexed) instead of failing every call.
+ */
+async function ensureIndexes(users) {
+  try {
+    await users.createIndex({ balance: -1 }); // leaderboard
+  } catch (error) {
+    console.error("Failed to create economy balance index:", error);
+  }
+
+  try {
+    await users.createIndex({ userId: 1 }, { unique: true });
+  } catch (error) {
+    if (error.code !== 11000) {
+      console.error("Failed to create economy userId index:", error);
+      return;
+    }
+    try {
+      const removed = await removeDuplicateUsers(users);
+      console.warn(`Removed ${removed} duplicate economy user document(s).`);
+      await users.createIndex({ userId: 1 }, { unique: true });
+    } catch (retryError) {
+      console.error("Failed to create economy userId index after removing duplicates:", retryError);
+    }
+  }
+}
+
+/**
+ * Atomically apply `delta` to a user's balance if they hold at least `required`.
+ * New users are created with DEFAULT_BALANCE in the same round-trip.
+ * @returns {Promise<{ ok: boolean, balance: number }>}
+ */
+async function applyDelta(userId, delta, required = 0) {
+  const users = await connectDB();
+  const current = { $ifNull: ["$balance", DEFAULT_BALANCE] };
+
+  // Pipeline update: the sufficiency check and the write happen in one atomic operation.
+  const before = await users.findOneAndUpdate(
+    { userId },
+    [{
+      $set: {
+        balance: {
+          $cond: [{ $gte: [current, required] }, { $add: [current, delta] }, current],
+        },
+      },
+    }],
+    { upsert: true, returnDocument: "before", includeResultMetadata: false }
+  );
+
+  const previous = before?.balance ?? DEFAULT_BALANCE;
+  const ok = previous >= required;
+  return { ok, balance: ok ? previous + delta : previous };
+}
+
+// ---- Optional write-behind mode -------------------------------------------
+
+// Cached committed balances beyond this are evicted, oldest first.
+const MAX_COMMITTED = 10000;
+
+const writeBehind = {
+  enabled: false,
+  timer: null,
+  committed: new Map(), // userId -> last balance known to be in MongoDB
+  pending: new Map(),   // userId -> delta not yet flushed
+  inflight: new Map(),  // userId -> delta currently being flushed
+  flushing: null,
+};
+
+async function loadCommitted(userId) {
+  const known = writeBehind.committed.get(userId);
+  if (known !== undefined) {
+    // Move to the back so recently active users are evicted last.
+    writeBehind.committed.delete(userId);
+    writeBehind.committed.set(userId, known);
+    return;
+  }
+  const users = await connectDB();
+  const user = await users.findOne({ userId }, { projection: { balance: 1 } });
+  // Another caller may have loaded it while we waited.
+  if (!writeBehind.committed.has(userId)) {
+    writeBehind.committed.set(userId, user?.balance ?? DEFAULT_BALANCE);
+  }
+}
+
+// Drop the least recently used balances that have nothing buffered.
+function evictCommitted() {
+  let excess = writeBehind.committed.size - MAX_COMMITTED;
+  if (excess <= 0) return;
+  for (const userId of writeBehind.committed.keys()) {
+    if (excess <= 0) break;
+    if (writeBehind.pending.has(userId) || writeBehind.inflight.has(userId)) continue;
+    writeBehind.committed.delete(userId);
+    excess--;
   }
 }
 
+// Synchronous so the check-and-buffer below cannot interleave with another bet.
+function bufferedBalance(userId) {
+  return writeBehind.committed.get(userId)
+    + (writeBehind.inflight.get(userId) || 0)
+    + (writeBehind.pending.get(userId) || 0);
+}
+
+async function cachedBalance(userId) {
+  await loadCommitted(userId);
+  return bufferedBalance(userId);
+}
+
+async function applyDeltaBuffered(userId, delta, required = 0) {
+  await loadCommitted(userId);
+  const previous = bufferedBalance(userId);
+  if (previous < required) return { ok: false, balance: previous };
+  writeBehind.pending.set(userId, (writeBehind.pending.get(userId) || 0) + delta);
+  return { ok: true, balance: previous + delta };
+}
+
 /**
- * Retrieves the user document from the database.
- * If the user doesn't exist, creates one with a default balance.
+ * Push buffered balance deltas to MongoDB in a single bulkWrite.
+ */
+async function flushPending() {
+  while (writeBehind.flushing) await writeBehind.flushing;
+  if (writeBehind.pending.size === 0) return;
+
+  writeBehind.flushing = writeBatch().finally(() => {
+    writeBehind.flushing = null;
+  });
+  return writeBehind.flushing;
+}
+
+async function writeBatch() {
+  const batch = writeBehind.pending;
+  writeBehind.pending = new Map();
+  writeBehind.inflight = batch;
+
+  const ops = [...batch].map(([userId, delta]) => ({
+    updateOne: {
+      filter: { userId },
+      update: [{ $set: { balance: { $add: [{ $ifNull: ["$balance", DEFAULT_BALANCE] }, delta] } } }],
+      upsert: true,
+    },
+  }));
+
+  const entries = [...batch];
+  let failed = entries;
+  try {
+    const users = await connectDB();
+    await users.bulkWrite(ops, { ordered: false });
+    failed = [];
+  } catch (error) {
+    // With ordered:false every op without a write error was applied; only retry the rest.
+    if (Array.isArray(error.writeErrors)) {
+      failed = error.writeErrors.map(writeError => entries[writeError.index]);
+    }
+    console.error(`Economy write-behind flush failed for ${failed.length} user(s), will retry:`, error);
+  }
+
+  const retry = new Set(failed.map(([userId]) => userId));
+  for (const [userId, delta] of entries) {
+    if (retry.has(userId)) {
+      writeBehind.pending.set(userId, (writeBehind.pending.get(userId) || 0) + delta);
+    } else {
+      writeBehind.committed.set(userId, writeBehind.committed.get(userId) + delta);
+    }
+  }
+  writeBehind.inflight = new Map();
+  evictCommitted();
+}
+
+/**
+ * Buffer balance changes in memory and write them in periodic batches.
+ * Only safe while this process is the sole writer of the economy collection.
+ * @param {{ interval?: number }} [options]
+ */
+function enableWriteBehind({ interval = 2000 } = {}) {
+  if (writeBehind.enabled) return;
+  writeBehind.enabled = true;
+  writeBehind.timer = setInterval(() => flushPending(), interval);
+  writeBehind.timer.unref?.();
+}
+
+/**
+ * Flush everything and return to direct writes.
+ */
+async function disableWriteBehind() {
+  if (!writeBehind.enabled) return;
+  clearInterval(writeBehind.timer);
+  writeBehind.timer = null;
+  while (writeBehind.pending.size > 0) {
+    await flushPending();
+  }
+  writeBehind.enabled = false;
+  writeBehind.committed.clear();
+}
+
+// ---- Ledger API ------------------------------------------------------------
+
+/**
+ * Add coins to a user.
+ * @returns {Promise<{ ok: boolean, balance: number }>}
+ */
+function credit(userId, amount) {
+  return writeBehind.enabled
+    ? applyDeltaBuffered(userId, amount, -Infinity)
+    : applyDelta(userId, amount, -Infinity);
+}
+
+/**
+ * Take coins from a user; never overdraws (ok is false if funds are short).
+ * @returns {Promise<{ ok: boolean, balance: number }>}
+ */
+function debit(userId, amount) {
+  return writeBehind.enabled
+    ? applyDeltaBuffered(userId, -amount, amount)
+    : applyDelta(userId, -amount, amount);
+}
+
+/**
+ * Settle a wager in one operation: requires `stake`, applies `payout - stake`.
+ * @returns {Promise<{ ok: boolean, balance: number }>}
+ */
+function settleBet(userId, stake, payout) {
+  return writeBehind.enabled
+    ? applyDeltaBuffered(userId, payout - stake, stake)
+    : applyDelta(userId, payout - stake, stake);
+}
+
+/**
+ * Returns the user document, or a default one for users we have not seen.
  * @param {string} userId - The Discord user ID.
  * @returns {Promise<Object>} The user document.
  */
 async function getUser(userId) {
-  const database = await connectDB();
-  const collection = database.collection("users");
-  let user = await collection.findOne({ userId });
-  if (!user) {
-    user = { userId, balance: DEFAULT_BALANCE };
-    await collection.insertOne(user);
-  }
-  return user;
+  const users = await connectDB();
+  const user = await users.findOne({ userId });
+  const balance = await getBalance(userId);
+  return { ...(user || { userId }), balance };
 }
 
 /**
- * Returns the current balance of the user.
+ * Returns the current balance of the user (no write for new users).
  * @param {string} userId - The Discord user ID.
  * @returns {Promise<number>} The user's balance.
  */
 async function getBalance(userId) {
-  const user = await getUser(userId);
-  return user.balance;
+  if (writeBehind.enabled) return cachedBalance(userId);
+  const users = await connectDB();
+  const user = await users.findOne({ userId }, { projection: { balance: 1 } });
+  return user?.balance ?? DEFAULT_BALANCE;
 }
 
 /**
  * Updates the user's balance by a given amount.
- * If the user doesn't exist, it creates the document first.
  * Amount can be positive (to add money) or negative (to subtract money).
+ * Purchases should use debit() and check `ok` instead of passing a negative amount.
  * @param {string} userId - The Discord user ID.
  * @param {number} amount - The amount to change (can be negative).
  * @returns {Promise<number>} The updated balance.
+ * @throws {Error} code INSUFFICIENT_FUNDS if a subtraction exceeds the balance (nothing is changed).
  */
 async function updateBalance(userId, amount) {
-  // Ensure the user is registered.
-  await getUser(userId);
-
-  const database = await connectDB();
-  const collection = database.collection("users");
-  // Use findOneAndUpdate with upsert; in some versions, you may need to re-fetch if result.value is null.
-  const result = await collection.findOneAndUpdate(
-    { userId },
-    { $inc: { balance: amount } },
-    { returnDocument: "after", upsert: true }
-  );
+  if (amount >= 0) return (await credit(userId, amount)).balance;
 
-  // Fallback: if for any reason result.value is undefined, re-read the user document.
-  if (!result.value) {
-    const user = await getUser(userId);
-    return user.balance;
+  const { ok, balance } = await debit(userId, -amount);
+  if (!ok) {
+    const error = new Error(`Insufficient funds: balance ${balance} is less than ${-amount}.`);
+    error.code = "INSUFFICIENT_FUNDS";
+    throw error;
   }
-  return result.value.balance;
+  return balance;
 }
 
 /**
@@ -92,24 +342,45 @@ async function updateBalance(userId, amount) {
  * @returns {Promise<number>} The updated balance.
  */
 async function setBalance(userId, newBalance) {
-  const database = await connectDB();
-  const collection = database.collection("users");
-  const result = await collection.findOneAndUpdate(
-    { userId },
-    { $set: { balance: newBalance } },
-    { returnDocument: "after", upsert: true }
-  );
-  if (!result.value) {
-    const user = await getUser(userId);
-    return user.balance;
+  if (writeBehind.enabled) {
+    // Make sure nothing buffered lands on top of the new value.
+    while (writeBehind.pending.size > 0 || writeBehind.flushing) {
+      await flushPending();
+    }
   }
-  return result.value.balance;
+  const users = await connectDB();
+  await users.updateOne({ userId }, { $set: { balance: newBalance } }, { upsert: true });
+  if (writeBehind.enabled) writeBehind.committed.set(userId, newBalance);
+  return newBalance;
+}
+
+/**
+ * Top users by balance (served by the balance index).
+ * @param {number} [limit=10]
+ * @returns {Promise<Array<{ userId: string, balance: number }>>}
+ */
+async function getLeaderboard(limit = 10) {
+  if (writeBehind.enabled) await flushPending();
+  const users = await connectDB();
+  return users.find({}, { projection: { _id: 0, userId: 1, balance: 1 } })
+    .sort({ balance: -1 })
+    .limit(limit)
+    .toArray();
 }
 
 module.exports = {
+  DEFAULT_BALANCE,
   connectDB,
   getUser,
   getBalance,
   updateBalance,
+  addBalance: updateBalance,
   setBalance,
+  credit,
+  debit,
+  settleBet,
+  getLeaderboard,
+  enableWriteBehind,
+  disableWriteBehind,
+  flushPending,
 };
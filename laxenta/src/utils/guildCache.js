@@ -0,0 +1,203 @@
+const mongoose = require('mongoose');
+const GuildPrefix = require('./guildprefix');
+const AFK = require('../models/AFK');
+const { AFK_TTL_SECONDS } = require('../models/AFK');
+const { logger } = require('./logger');
+
+const DEFAULT_PREFIX = '!';
+const AFK_TTL_MS = AFK_TTL_SECONDS * 1000;
+
+// guildId -> prefix (the default prefix is cached too, so unknown guilds only cost one lookup)
+const prefixes = new Map();
+// `${guildId}:${userId}` -> expiry time (ms). Only AFK users ever live in here.
+const afkUsers = new Map();
+let afkLoaded = false;
+let afkLoading = null;
+// A failed AFK load is retried with backoff; until it succeeds lookups go to MongoDB.
+const AFK_RETRY_MIN_MS = 5000;
+const AFK_RETRY_MAX_MS = 5 * 60 * 1000;
+let afkRetryDelay = AFK_RETRY_MIN_MS;
+let afkRetryTimer = null;
+
+const stats = {
+  prefixHits: 0,
+  prefixMisses: 0,
+  afkHits: 0,
+  afkMisses: 0,
+  afkSkipped: 0,
+};
+
+const afkKey = (guildId, userId) => `${guildId}:${userId}`;
+
+/**
+ * Load every live AFK entry into memory once. Until this finishes
+ * lookups fall through to MongoDB so nothing is missed at startup.
+ */
+function loadAfkUsers() {
+  if (afkLoaded) return Promise.resolve();
+  if (afkLoading) return afkLoading;
+
+  afkLoading = AFK.find({}, { guildId: 1, userId: 1, timestamp: 1 }).lean()
+    .then((docs) => {
+      for (const doc of docs) {
+        afkUsers.set(afkKey(doc.guildId, doc.userId), new Date(doc.timestamp).getTime() + AFK_TTL_MS);
+      }
+      afkLoaded = true;
+      afkRetryDelay = AFK_RETRY_MIN_MS;
+      logger.info(`Guild cache: loaded ${docs.length} AFK entries`);
+    })
+    .catch((err) => {
+      logger.error(`Guild cache: failed to load AFK entries, retrying in ${afkRetryDelay / 1000}s: ${err.message}`);
+      scheduleAfkRetry();
+    })
+    .finally(() => {
+      afkLoading = null;
+    });
+  return afkLoading;
+}
+
+function scheduleAfkRetry() {
+  if (afkRetryTimer) return;
+  afkRetryTimer = setTimeout(() => {
+    afkRetryTimer = null;
+    loadAfkUsers();
+  }, afkRetryDelay);
+  afkRetryTimer.unref?.();
+  afkRetryDelay = Math.min(afkRetryDelay * 2, AFK_RETRY_MAX_MS);
+}
+
+if (mongoose.connection.readyState === 1) {
+  loadAfkUsers();
+} else {
+  mongoose.connection.once('connected', () => loadAfkUsers());
+}
+// No-op once loaded; otherwise a reconnect is the best moment to try again.
+mongoose.connection.on('reconnected', () => loadAfkUsers());
+
+/**
+ * Get the prefix for a guild, hitting MongoDB only on the first lookup.
+ * @param {string} guildId
+ * @returns {Promise<string>}
+ */
+async function getPrefix(guildId) {
+  const cached = prefixes.get(guildId);
+  if (cached !== undefined) {
+    stats.prefixHits++;
+    return cached;
+  }
+  stats.prefixMisses++;
+
+  try {
+    const guildSettings = await GuildPrefix.findOne({ guildId }, { prefix: 1 }).lean();
+    const prefix = guildSettings?.prefix || DEFAULT_PREFIX;
+    prefixes.set(guildId, prefix);
+    return prefix;
+  } catch (error) {
+    logger.error(`Error retrieving prefix for guild ${guildId}: ${error.message}`);
+    return DEFAULT_PREFIX;
+  }
+}
+
+/**
+ * Persist a new prefix and update the cache.
+ * @param {string} guildId
+ * @param {string} prefix
+ */
+async function setPrefix(guildId, prefix) {
+  const result = await GuildPrefix.findOneAndUpdate(
+    { guildId },
+    { prefix },
+    { new: true, upsert: true }
+  );
+  prefixes.set(guildId, prefix);
+  return result;
+}
+
+/**
+ * Whether a user may be AFK. Returns false without touching MongoDB once
+ * the AFK set is loaded; entries past the 24h TTL are dropped lazily.
+ */
+function mightBeAfk(guildId, userId) {
+  if (!afkLoaded) return true;
+
+  const key = afkKey(guildId, userId);
+  const expiresAt = afkUsers.get(key);
+  if (expiresAt === undefined) return false;
+  if (expiresAt <= Date.now()) {
+    afkUsers.delete(key);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Fetch the AFK entry for a user (or null).
+ */
+async function getAfk(guildId, userId) {
+  if (!mightBeAfk(guildId, userId)) {
+    stats.afkSkipped++;
+    return null;
+  }
+
+  const doc = await AFK.findOne({ guildId, userId });
+  doc ? stats.afkHits++ : stats.afkMisses++;
+  if (!doc) afkUsers.delete(afkKey(guildId, userId));
+  return doc;
+}
+
+/**
+ * Mark a user as AFK.
+ */
+async function setAfk(guildId, userId, reason) {
+  const doc = await AFK.create({ guildId, userId, reason });
+  afkUsers.set(afkKey(guildId, userId), doc.timestamp.getTime() + AFK_TTL_MS);
+  return doc;
+}
+
+/**
+ * Remove a user's AFK status. Returns the removed entry (or null) so callers
+ * can report how long they were away.
+ */
+async function clearAfk(guildId, userId) {
+  if (!mightBeAfk(guildId, userId)) {
+    stats.afkSkipped++;
+    return null;
+  }
+
+  const doc = await AFK.findOneAndDelete({ guildId, userId });
+  doc ? stats.afkHits++ : stats.afkMisses++;
+  afkUsers.delete(afkKey(guildId, userId));
+  return doc;
+}
+
+/**
+ * Drop cached state for a guild (e.g. when the bot leaves it).
+ */
+function invalidateGuild(guildId) {
+  prefixes.delete(guildId);
+  const prefix = `${guildId}:`;
+  for (const key of afkUsers.keys()) {
+    if (key.startsWith(prefix)) afkUsers.delete(key);
+  }
+}
+
+function getCacheStats() {
+  return {
+    ...stats,
+    prefixes: prefixes.size,
+    afkUsers: afkUsers.size,
+    afkLoaded,
+  };
+}
+
+module.exports = {
+  DEFAULT_PREFIX,
+  getPrefix,
+  setPrefix,
+  getAfk,
+  setAfk,
+  clearAfk,
+  invalidateGuild,
+  loadAfkUsers,
+  getCacheStats,
+};
@@ -0,0 +1,227 @@
+const fs = require('fs');
+const path = require('path');
+const { logger } = require('./logger');
+
+const DEFAULT_FLUSH_DELAY = 2000; // coalesce bursts of mutations into one write
+
+const stores = new Map();
+
+/**
+ * In-memory JSON dataset backed by a file.
+ *
+ * The file is read once at startup; afterwards reads are served from memory.
+ * Every mutation is appended to `<file>.log` (one JSON line per top-level key)
+ * so a crash loses nothing, and a debounced flush rewrites the file atomically
+ * (write temp, then rename) and truncates the log.
+ */
+class JsonStore {
+    constructor(filePath, options = {}) {
+        this.filePath = filePath;
+        this.logPath = `${filePath}.log`;
+        this.tmpPath = `${filePath}.tmp`;
+        this.flushDelay = options.flushDelay ?? DEFAULT_FLUSH_DELAY;
+        this.space = options.pretty ? 2 : 0;
+
+        this.data = {};
+        this.seq = 0;          // bumped on every mutation
+        this.flushedSeq = 0;   // last mutation included in the main file
+        this.flushTimer = null;
+        this.flushing = null;
+        this.pendingLines = [];
+        this.logChain = Promise.resolve();
+
+        this.load();
+    }
+
+    // Startup only: read the snapshot, then replay any log left by a crash.
+    load() {
+        fs.mkdirSync(path.dirname(this.filePath), { recursive: true });
+
+        if (fs.existsSync(this.filePath)) {
+            try {
+                const raw = fs.readFileSync(this.filePath, 'utf8');
+                this.data = raw.trim() ? JSON.parse(raw) : {};
+            } catch (error) {
+                logger.error(`JsonStore: failed to read ${this.filePath}: ${error.message}`);
+                this.data = {};
+            }
+        }
+
+        if (fs.existsSync(this.logPath)) {
+            const lines = fs.readFileSync(this.logPath, 'utf8').split('\n');
+            let replayed = 0;
+            for (const line of lines) {
+                if (!line) continue;
+                try {
+                    const entry = JSON.parse(line);
+                    if (entry.d) delete this.data[entry.k];
+                    else this.data[entry.k] = entry.v;
+                    replayed++;
+                } catch {
+                    // A torn final line from a crash mid-append; everything before it is valid.
+                }
+            }
+            if (replayed > 0) {
+                logger.info(`JsonStore: replayed ${replayed} log entries for ${path.basename(this.filePath)}`);
+                this.seq = 1;
+                this.scheduleFlush();
+            }
+        }
+    }
+
+    has(key) {
+        return Object.prototype.hasOwnProperty.call(this.data, key);
+    }
+
+    get(key) {
+        return this.data[key];
+    }
+
+    /**
+     * The live top-level object. Treat as read-only; mutate through set/update/delete.
+     */
+    all() {
+        return this.data;
+    }
+
+    set(key, value) {
+        this.data[key] = value;
+        this.record({ k: key, v: value });
+        return value;
+    }
+
+    /**
+     * Apply `fn` to the current value of `key` and store the result.
+     */
+    update(key, fn) {
+        return this.set(key, fn(this.data[key]));
+    }
+
+    delete(key) {
+        if (!this.has(key)) return false;
+        delete this.data[key];
+        this.record({ k: key, d: 1 });
+        return true;
+    }
+
+    /**
+     * Replace the whole dataset (used by legacy read-modify-write callers).
+     */
+    replace(data) {
+        for (const key of Object.keys(this.data)) {
+            if (!Object.prototype.hasOwnProperty.call(data, key)) this.delete(key);
+        }
+        for (const [key, value] of Object.entries(data)) this.set(key, value);
+    }
+
+    record(entry) {
+        this.seq++;
+        this.pendingLines.push(JSON.stringify(entry));
+        if (this.pendingLines.length === 1) {
+            // Batch every mutation made in this tick into one append.
+            this.logChain = this.logChain.then(() => this.drainLog());
+        }
+        this.scheduleFlush();
+    }
+
+    async drainLog() {
+        if (this.pendingLines.length === 0) return;
+        const chunk = this.pendingLines.join('\n') + '\n';
+        this.pendingLines = [];
+        try {
+            await fs.promises.appendFile(this.logPath, chunk);
+        } catch (error) {
+            logger.error(`JsonStore: failed to append to ${this.logPath}: ${error.message}`);
+        }
+    }
+
+    scheduleFlush() {
+        if (this.flushTimer) return;
+        this.flushTimer = setTimeout(() => {
+            this.flushTimer = null;
+            this.flush().catch(error =>
+                logger.error(`JsonStore: flush of ${this.filePath} failed: ${error.message}`));
+        }, this.flushDelay);
+        this.flushTimer.unref?.();
+    }
+
+    /**
+     * Write the in-memory dataset to disk atomically.
+     */
+    async flush() {
+        while (this.flushing) await this.flushing.catch(() => {});
+        if (this.seq === this.flushedSeq) return;
+
+        this.flushing = (async () => {
+            const snapshotSeq = this.seq;
+            const body = JSON.stringify(this.data, null, this.space);
+
+            await fs.promises.writeFile(this.tmpPath, body, 'utf8');
+            await fs.promises.rename(this.tmpPath, this.filePath);
+            this.flushedSeq = snapshotSeq;
+
+            // Only truncate when the snapshot covers every logged mutation;
+            // otherwise the pending flush will do it.
+            if (this.seq === snapshotSeq) {
+                this.logChain = this.logChain.then(() =>
+                    fs.promises.truncate(this.logPath, 0).catch(error => {
+                        if (error.code !== 'ENOENT') {
+                            logger.error(`JsonStore: failed to truncate ${this.logPath}: ${error.message}`);
+                        }
+                    }));
+                await this.logChain;
+            }
+        })();
+
+        try {
+            await this.flushing;
+        } finally {
+            this.flushing = null;
+        }
+    }
+
+    /**
+     * Synchronous last-chance write, used on process exit.
+     */
+    flushSync() {
+        if (this.seq === this.flushedSeq) return;
+        fs.writeFileSync(this.tmpPath, JSON.stringify(this.data, null, this.space), 'utf8');
+        fs.renameSync(this.tmpPath, this.filePath);
+        fs.writeFileSync(this.logPath, '');
+        this.flushedSeq = this.seq;
+        this.pendingLines = [];
+    }
+}
+
+/**
+ * Get the shared store for a file. Every module opening the same path gets
+ * the same instance, so they always see each other's changes.
+ * @param {string} filePath
+ * @param {{ pretty?: boolean, flushDelay?: number }} [options]
+ * @returns {JsonStore}
+ */
+function openStore(filePath, options) {
+    const resolved = path.resolve(filePath);
+    let store = stores.get(resolved);
+    if (!store) {
+        store = new JsonStore(resolved, options);
+        stores.set(resolved, store);
+    }
+    return store;
+}
+
+async function flushAll() {
+    await Promise.all([...stores.values()].map(store => store.flush()));
+}
+
+process.once('exit', () => {
+    for (const store of stores.values()) {
+        try {
+            store.flushSync();
+        } catch (error) {
+            console.error(`JsonStore: exit flush of ${store.filePath} failed:`, error);
+        }
+    }
+});
+
+module.exports = { JsonStore, openStore, flushAll };
@@ -10,11 +10,23 @@ const logLevels = {
     debug: { color: (msg) => msg, level: 4 },
 };
 
-// Always set the log level to 'debug' to show all logs
-const LOG_LEVEL = 'debug';
+// LOG_LEVEL filters before any formatting happens; LOG_FORMAT=json emits one JSON object per line
+const LOG_LEVEL = logLevels[process.env.LOG_LEVEL] ? process.env.LOG_LEVEL : 'info';
+const JSON_FORMAT = process.env.LOG_FORMAT === 'json';
+const ERROR_LOG_PATH = path.join(__dirname, 'error.log');
 
-// Utility to format timestamp
-const formatTimestamp = () => new Date().toISOString();
+// Lines waiting to be written. Past this, debug/info lines are dropped rather than growing without bound.
+const MAX_BUFFERED_LINES = 10000;
+
+const stats = {
+    lines: { fatal: 0, error: 0, warn: 0, info: 0, debug: 0 },
+    dropped: 0,
+};
+
+let outBuffer = [];
+let errorBuffer = [];
+let flushScheduled = false;
+let waitingForDrain = false;
 
 // Dynamically import chalk and apply colors to log levels
 async function loadChalk() {
@@ -31,33 +43,129 @@ async function loadChalk() {
 }
 
 // Initialize chalk colors (run this once on startup)
-loadChalk().catch(console.error);
+if (!JSON_FORMAT) loadChalk().catch(console.error);
 
-// General log function
-function log(level, message) {
-    const logLevel = logLevels[level];
-    if (logLevel && logLevel.level <= logLevels[LOG_LEVEL].level) {
-        const timestamp = formatTimestamp();
-        const formattedMessage = `${timestamp} [${level.toUpperCase()}]: ${message}`;
-
-        // Console output with dynamic color (color applied once chalk is loaded)
-        console.log(logLevel.color ? logLevel.color(formattedMessage) : formattedMessage);
-
-        // Asynchronous file output for errors
-        if (level === 'error' || level === 'fatal') {
-            fs.promises.appendFile(path.join(__dirname, 'error.log'), `${formattedMessage}\n`)
-                .catch(err => console.error("Failed to write to error log file:", err));
+function serializeError(error) {
+    return { message: error.message, stack: error.stack, ...(error.code !== undefined && { code: error.code }) };
+}
+
+// Extra arguments become structured fields; strings and numbers are appended to the message.
+function collectMeta(args) {
+    const fields = {};
+    const extra = [];
+    for (const arg of args) {
+        if (arg instanceof Error) {
+            fields.error = serializeError(arg);
+        } else if (arg && typeof arg === 'object') {
+            for (const [key, value] of Object.entries(arg)) {
+                fields[key] = value instanceof Error ? serializeError(value) : value;
+            }
+        } else if (arg !== undefined) {
+            extra.push(String(arg));
+        }
+    }
+    return { fields, extra };
+}
+
+function safeStringify(value) {
+    try {
+        return JSON.stringify(value);
+    } catch {
+        return '"[unserializable]"';
+    }
+}
+
+function formatLine(level, message, args) {
+    const time = new Date().toISOString();
+    const { fields, extra } = collectMeta(args);
+    const msg = extra.length > 0 ? `${message} ${extra.join(' ')}` : String(message);
+
+    if (JSON_FORMAT) {
+        return safeStringify({ time, level, msg, ...fields });
+    }
+
+    let line = `${time} [${level.toUpperCase()}]: ${msg}`;
+    if (Object.keys(fields).length > 0) {
+        const { error, ...rest } = fields;
+        if (Object.keys(rest).length > 0) line += ` ${safeStringify(rest)}`;
+        if (error) line += `\n${error.stack || error.message}`;
+    }
+    return line;
+}
+
+function enqueue(level, line) {
+    if (outBuffer.length >= MAX_BUFFERED_LINES && logLevels[level].level >= logLevels.info.level) {
+        stats.dropped++;
+        return;
+    }
+    outBuffer.push(JSON_FORMAT ? line : logLevels[level].color(line));
+    if (level === 'error' || level === 'fatal') errorBuffer.push(line);
+    scheduleFlush();
+}
+
+function scheduleFlush() {
+    if (flushScheduled || waitingForDrain) return;
+    flushScheduled = true;
+    setImmediate(flush);
+}
+
+// One write per event-loop turn instead of one per call.
+function flush() {
+    flushScheduled = false;
+
+    if (outBuffer.length > 0) {
+        const chunk = outBuffer.join('\n') + '\n';
+        outBuffer = [];
+        if (!process.stdout.write(chunk)) {
+            waitingForDrain = true;
+            process.stdout.once('drain', () => {
+                waitingForDrain = false;
+                if (outBuffer.length > 0) scheduleFlush();
+            });
         }
     }
+
+    if (errorBuffer.length > 0) {
+        const chunk = errorBuffer.join('\n') + '\n';
+        errorBuffer = [];
+        fs.promises.appendFile(ERROR_LOG_PATH, chunk)
+            .catch(err => console.error("Failed to write to error log file:", err));
+    }
+}
+
+/**
+ * Write everything still buffered before the process goes away.
+ */
+function flushSync() {
+    try {
+        if (outBuffer.length > 0) fs.writeSync(process.stdout.fd, outBuffer.join('\n') + '\n');
+        if (errorBuffer.length > 0) fs.appendFileSync(ERROR_LOG_PATH, errorBuffer.join('\n') + '\n');
+    } catch {
+        // Nothing left to report to
+    }
+    outBuffer = [];
+    errorBuffer = [];
+}
+
+process.once('exit', flushSync);
+
+// General log function
+function log(level, message, ...args) {
+    if (logLevels[level].level > logLevels[LOG_LEVEL].level) return;
+    stats.lines[level]++;
+    enqueue(level, formatLine(level, message, args));
 }
 
 // Define specific log level functions
 const logger = {
-    fatal: (msg) => log('fatal', msg),
-    error: (msg) => log('error', msg),
-    warn: (msg) => log('warn', msg),
-    info: (msg) => log('info', msg),
-    debug: (msg) => log('debug', msg),
+    fatal: (msg, ...meta) => log('fatal', msg, ...meta),
+    error: (msg, ...meta) => log('error', msg, ...meta),
+    warn: (msg, ...meta) => log('warn', msg, ...meta),
+    info: (msg, ...meta) => log('info', msg, ...meta),
+    debug: (msg, ...meta) => log('debug', msg, ...meta),
+    isLevelEnabled: (level) => logLevels[level].level <= logLevels[LOG_LEVEL].level,
+    flushSync,
+    getStats: () => ({ ...stats, lines: { ...stats.lines }, buffered: outBuffer.length }),
 };
 
 // Error handler function
@@ -67,9 +175,10 @@ function handleError(error, isFatal = false) {
 
     if (isFatal) {
         logger.fatal("Fatal error encountered, shutting down...");
+        flushSync();
         process.exit(1); // Exit only for fatal errors
     }
 }
 
-// :3 Exporting logger and error handler 
+// :3 Exporting logger and error handler
 module.exports = { logger, handleError };
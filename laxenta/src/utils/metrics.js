@@ -0,0 +1,251 @@
+const { monitorEventLoopDelay } = require('perf_hooks');
+const v8 = require('v8');
+
+/**
+ * Minimal in-process metrics registry with Prometheus text exposition.
+ *
+ * Hot paths only touch a Map entry per observation; everything derived
+ * (event-loop lag, heap, stats kept by other modules) is gathered by
+ * collectors when `/api/metrics` is scraped.
+ */
+
+const CONTENT_TYPE = 'text/plain; version=0.0.4; charset=utf-8';
+
+const COMMAND_BUCKETS = [0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30];
+const MONGO_BUCKETS = [0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5];
+
+const metrics = new Map();
+const collectors = [];
+
+function escapeLabel(value) {
+    return String(value).replace(/\\/g, '\\\\').replace(/"/g, '\\"').replace(/\n/g, '\\n');
+}
+
+function formatValue(value) {
+    if (value === Infinity) return '+Inf';
+    if (value === -Infinity) return '-Inf';
+    return Number.isFinite(value) ? String(value) : 'NaN';
+}
+
+class Metric {
+    constructor(type, name, help, labelNames = []) {
+        this.type = type;
+        this.name = name;
+        this.help = help;
+        this.labelNames = labelNames;
+        this.series = new Map(); // label values joined -> series
+    }
+
+    key(labels) {
+        return this.labelNames.map(name => labels[name] ?? '').join('\u0001');
+    }
+
+    labelText(labels, extra = '') {
+        const parts = this.labelNames.map(name => `${name}="${escapeLabel(labels[name] ?? '')}"`);
+        if (extra) parts.push(extra);
+        return parts.length > 0 ? `{${parts.join(',')}}` : '';
+    }
+
+    reset() {
+        this.series.clear();
+    }
+}
+
+class Counter extends Metric {
+    constructor(name, help, labelNames) {
+        super('counter', name, help, labelNames);
+    }
+
+    inc(labels = {}, value = 1) {
+        const key = this.key(labels);
+        const series = this.series.get(key);
+        if (series) series.value += value;
+        else this.series.set(key, { labels, value });
+    }
+
+    /**
+     * Mirror a running total kept by another module.
+     */
+    set(labels, value) {
+        this.series.set(this.key(labels), { labels, value });
+    }
+
+    render() {
+        return [...this.series.values()].map(s => `${this.name}${this.labelText(s.labels)} ${formatValue(s.value)}`);
+    }
+}
+
+class Gauge extends Counter {
+    constructor(name, help, labelNames) {
+        super(name, help, labelNames);
+        this.type = 'gauge';
+    }
+}
+
+class Histogram extends Metric {
+    constructor(name, help, labelNames, buckets) {
+        super('histogram', name, help, labelNames);
+        this.buckets = buckets;
+    }
+
+    observe(labels, value) {
+        const key = this.key(labels);
+        let series = this.series.get(key);
+        if (!series) {
+            series = { labels, counts: new Float64Array(this.buckets.length), sum: 0, count: 0 };
+            this.series.set(key, series);
+        }
+        // Counts are stored per bucket and accumulated when rendering.
+        const index = this.buckets.findIndex(bound => value <= bound);
+        if (index !== -1) series.counts[index]++;
+        series.sum += value;
+        series.count++;
+    }
+
+    render() {
+        const lines = [];
+        for (const s of this.series.values()) {
+            let cumulative = 0;
+            this.buckets.forEach((bound, i) => {
+                cumulative += s.counts[i];
+                lines.push(`${this.name}_bucket${this.labelText(s.labels, `le="${bound}"`)} ${cumulative}`);
+            });
+            lines.push(`${this.name}_bucket${this.labelText(s.labels, 'le="+Inf"')} ${s.count}`);
+            lines.push(`${this.name}_sum${this.labelText(s.labels)} ${formatValue(s.sum)}`);
+            lines.push(`${this.name}_count${this.labelText(s.labels)} ${s.count}`);
+        }
+        return lines;
+    }
+}
+
+function register(MetricClass, name, ...args) {
+    const existing = metrics.get(name);
+    if (existing) return existing;
+    const metric = new MetricClass(name, ...args);
+    metrics.set(name, metric);
+    return metric;
+}
+
+const createCounter = (name, help, labelNames) => register(Counter, name, help, labelNames);
+const createGauge = (name, help, labelNames) => register(Gauge, name, help, labelNames);
+const createHistogram = (name, help, labelNames, buckets) => register(Histogram, name, help, labelNames, buckets);
+
+/**
+ * Run `fn` at scrape time, before rendering, to refresh gauges.
+ */
+function addCollector(fn) {
+    collectors.push(fn);
+}
+
+async function render() {
+    for (const collect of collectors) {
+        try {
+            await collect();
+        } catch (error) {
+            console.error('Metrics collector failed:', error.message);
+        }
+    }
+
+    const lines = [];
+    for (const metric of metrics.values()) {
+        const body = metric.render();
+        if (body.length === 0) continue;
+        lines.push(`# HELP ${metric.name} ${metric.help}`, `# TYPE ${metric.name} ${metric.type}`, ...body);
+    }
+    return lines.join('\n') + '\n';
+}
+
+// ---- Commands --------------------------------------------------------------
+
+const commandDuration = createHistogram(
+    'bot_command_duration_seconds',
+    'Time spent executing a command, by kind (prefix, slash, button) and outcome.',
+    ['type', 'command', 'status'],
+    COMMAND_BUCKETS
+);
+
+/**
+ * Start timing a command; call the returned function with 'ok' or 'error'.
+ */
+function startCommandTimer(type, command) {
+    const start = process.hrtime.bigint();
+    return (status = 'ok') => {
+        const seconds = Number(process.hrtime.bigint() - start) / 1e9;
+        commandDuration.observe({ type, command, status }, seconds);
+    };
+}
+
+// ---- MongoDB ---------------------------------------------------------------
+
+const mongoDuration = createHistogram(
+    'mongodb_operation_duration_seconds',
+    'Round-trip time of MongoDB commands, by collection and command.',
+    ['collection', 'op', 'status'],
+    MONGO_BUCKETS
+);
+const instrumentedClients = new WeakSet();
+
+/**
+ * Time every command the driver sends. Needs the connection to be opened with
+ * `monitorCommands: true`, otherwise the driver emits no command events.
+ */
+function instrumentMongoose(mongoose) {
+    const attach = () => {
+        const client = mongoose.connection.getClient();
+        if (!client || instrumentedClients.has(client)) return;
+        instrumentedClients.add(client);
+
+        const started = new Map(); // requestId -> collection
+        client.on('commandStarted', (event) => {
+            const target = event.command?.[event.commandName];
+            started.set(event.requestId, typeof target === 'string' ? target : (event.command?.collection || 'none'));
+        });
+        const finish = (status) => (event) => {
+            const collection = started.get(event.requestId) || 'none';
+            started.delete(event.requestId);
+            mongoDuration.observe({ collection, op: event.commandName, status }, event.duration / 1000);
+        };
+        client.on('commandSucceeded', finish('ok'));
+        client.on('commandFailed', finish('error'));
+    };
+
+    mongoose.connection.on('connected', attach);
+    if (mongoose.connection.readyState === 1) attach();
+}
+
+// ---- Process ---------------------------------------------------------------
+
+const loopDelay = monitorEventLoopDelay({ resolution: 10 });
+loopDelay.enable();
+
+const eventLoopLag = createGauge('nodejs_eventloop_lag_seconds', 'Event-loop delay since the previous scrape.', ['quantile']);
+const memory = createGauge('nodejs_memory_bytes', 'Process memory usage.', ['type']);
+const heapSpace = createGauge('nodejs_heap_space_used_bytes', 'Used size of each V8 heap space.', ['space']);
+const uptime = createGauge('process_uptime_seconds', 'Seconds since the process started.');
+
+addCollector(() => {
+    eventLoopLag.set({ quantile: '0.5' }, loopDelay.percentile(50) / 1e9);
+    eventLoopLag.set({ quantile: '0.99' }, loopDelay.percentile(99) / 1e9);
+    eventLoopLag.set({ quantile: '1' }, loopDelay.max / 1e9);
+    loopDelay.reset();
+
+    const usage = process.memoryUsage();
+    for (const type of ['rss', 'heapTotal', 'heapUsed', 'external', 'arrayBuffers']) {
+        memory.set({ type }, usage[type]);
+    }
+    for (const space of v8.getHeapSpaceStatistics()) {
+        heapSpace.set({ space: space.space_name }, space.space_used_size);
+    }
+    uptime.set({}, process.uptime());
+});
+
+module.exports = {
+    CONTENT_TYPE,
+    createCounter,
+    createGauge,
+    createHistogram,
+    addCollector,
+    render,
+    startCommandTimer,
+    instrumentMongoose,
+};
@@ -0,0 +1,136 @@
+/**
+ * Sliding-window message tracker used by the anti-spam module.
+ *
+ * Each (guild, user) pair gets a fixed-size ring of its most recent messages
+ * (timestamp, channelId, messageId) instead of keeping Message objects around.
+ * Users that go quiet for longer than the idle timeout are evicted by a sweep,
+ * so memory is bounded by the number of *active* users.
+ */
+
+const DEFAULT_IDLE_TIMEOUT = 60000; // 1 minute without messages
+const DEFAULT_SWEEP_INTERVAL = 30000;
+
+class MessageRing {
+    constructor(capacity) {
+        this.times = new Float64Array(capacity);
+        this.channelIds = new Array(capacity);
+        this.messageIds = new Array(capacity);
+        this.head = 0;   // next write position
+        this.size = 0;
+        this.lastSeen = 0;
+    }
+
+    push(timestamp, channelId, messageId) {
+        const capacity = this.times.length;
+        this.times[this.head] = timestamp;
+        this.channelIds[this.head] = channelId;
+        this.messageIds[this.head] = messageId;
+        this.head = (this.head + 1) % capacity;
+        if (this.size < capacity) this.size++;
+        this.lastSeen = timestamp;
+    }
+
+    /**
+     * Count messages newer than `since`, walking back from the newest one.
+     */
+    countSince(since) {
+        const capacity = this.times.length;
+        let count = 0;
+        for (let i = 1; i <= this.size; i++) {
+            const idx = (this.head - i + capacity) % capacity;
+            if (this.times[idx] < since) break;
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * Messages newer than `since`, grouped as channelId -> [messageId].
+     */
+    collectSince(since) {
+        const capacity = this.times.length;
+        const byChannel = new Map();
+        for (let i = 1; i <= this.size; i++) {
+            const idx = (this.head - i + capacity) % capacity;
+            if (this.times[idx] < since) break;
+            const channelId = this.channelIds[idx];
+            if (!byChannel.has(channelId)) byChannel.set(channelId, []);
+            byChannel.get(channelId).push(this.messageIds[idx]);
+        }
+        return byChannel;
+    }
+
+    clear() {
+        this.size = 0;
+    }
+}
+
+class SpamTracker {
+    /**
+     * @param {object} [options]
+     * @param {number} [options.maxLimit] largest message limit any guild may use (sets the ring size)
+     * @param {number} [options.idleTimeout] evict users idle for this long (ms)
+     * @param {number} [options.sweepInterval] how often to sweep idle users (ms), 0 to disable
+     */
+    constructor({ maxLimit = 20, idleTimeout = DEFAULT_IDLE_TIMEOUT, sweepInterval = DEFAULT_SWEEP_INTERVAL } = {}) {
+        this.capacity = maxLimit + 1;
+        this.idleTimeout = idleTimeout;
+        this.rings = new Map();
+        this.sweepTimer = null;
+
+        if (sweepInterval > 0) {
+            this.sweepTimer = setInterval(() => this.sweep(), sweepInterval);
+            this.sweepTimer.unref?.();
+        }
+    }
+
+    /**
+     * Record a message and report whether the user is over the limit.
+     * @returns {boolean} true once more than `limit` messages fell inside `timeFrame`
+     */
+    record(guildId, userId, channelId, messageId, { limit, timeFrame }, now = Date.now()) {
+        const key = `${guildId}:${userId}`;
+        let ring = this.rings.get(key);
+        if (!ring) {
+            ring = new MessageRing(this.capacity);
+            this.rings.set(key, ring);
+        }
+
+        ring.push(now, channelId, messageId);
+        return ring.countSince(now - timeFrame) > Math.min(limit, this.capacity - 1);
+    }
+
+    /**
+     * Take the user's recent messages (grouped by channel) and reset their window.
+     */
+    drain(guildId, userId, timeFrame, now = Date.now()) {
+        const ring = this.rings.get(`${guildId}:${userId}`);
+        if (!ring) return new Map();
+        const byChannel = ring.collectSince(now - timeFrame);
+        ring.clear();
+        return byChannel;
+    }
+
+    sweep(now = Date.now()) {
+        const cutoff = now - this.idleTimeout;
+        let evicted = 0;
+        for (const [key, ring] of this.rings) {
+            if (ring.lastSeen < cutoff) {
+                this.rings.delete(key);
+                evicted++;
+            }
+        }
+        return evicted;
+    }
+
+    get size() {
+        return this.rings.size;
+    }
+
+    stop() {
+        if (this.sweepTimer) clearInterval(this.sweepTimer);
+        this.sweepTimer = null;
+    }
+}
+
+module.exports = { SpamTracker };
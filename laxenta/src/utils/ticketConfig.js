@@ -27,7 +27,8 @@ class TicketConfig {
                 welcomeMessage: '<a:wel:1342444020726501407> Please be patient! Support will be with you shortly!',
                 maxTickets: 1, //only 1 ticker per person is enough honestly
                 pingRoles: [],
-                closeDelay: 5000 // 5 seconds delay before closing the ticket
+                closeDelay: 5000, // 5 seconds delay before closing the ticket
+                transcriptHtml: true // attach a readable HTML copy next to the .ndjson.gz
             }
         };
         this.init();
@@ -3,21 +3,30 @@ const path = require('path');
 const { EmbedBuilder, ButtonBuilder, ActionRowBuilder, ButtonStyle, PermissionFlagsBits } = require('discord.js');
 const { Colors } = require('./constants');
 const ticketConfig = require('./ticketConfig');
+const { openStore } = require('./jsonStore');
+const { writeTranscript } = require('./ticketTranscript');
 const { logger } = require('./logger');
 
 class TicketManager {
     constructor() {
-        this.tickets = new Map();
-        this.dataPath = path.join(process.cwd(), 'data', 'tickets.json');
+        const dataDir = path.join(process.cwd(), 'data');
+        // channelId -> ticket; each change is appended to the store's log, not a full rewrite
+        this.tickets = openStore(path.join(dataDir, 'tickets.json'), { pretty: true });
+        // guildId -> last ticket number handed out
+        this.counters = openStore(path.join(dataDir, 'ticketCounters.json'));
+        this.transcriptDir = path.join(dataDir, 'transcripts');
+        this.byGuild = new Map(); // guildId -> Set<channelId>
         this.client = null;
+
+        for (const ticket of Object.values(this.tickets.all())) {
+            this.indexTicket(ticket);
+        }
         this.init();
     }
 
     async init() {
         try {
-            await fs.mkdir(path.join(process.cwd(), 'data'), { recursive: true });
-            await fs.mkdir(path.join(process.cwd(), 'data', 'transcripts'), { recursive: true });
-            await this.loadTickets();
+            await fs.mkdir(this.transcriptDir, { recursive: true });
         } catch (error) {
             console.error('Eh error initializing TicketManager:', error);
         }
@@ -27,27 +36,36 @@ class TicketManager {
         this.client = client;
     }
 
-    async loadTickets() {
-        try {
-            const data = await fs.readFile(this.dataPath, 'utf-8');
-            const tickets = JSON.parse(data);
-            this.tickets = new Map(Object.entries(tickets));
-        } catch (error) {
-            if (error.code !== 'ENOENT') {
-                console.error('Error loading tickets:', error);
-            }
-            await this.saveTickets();
+    indexTicket(ticket) {
+        let channels = this.byGuild.get(ticket.guildId);
+        if (!channels) {
+            channels = new Set();
+            this.byGuild.set(ticket.guildId, channels);
         }
+        channels.add(ticket.channelId);
     }
 
-    async saveTickets() {
-        try {
-            const ticketData = Object.fromEntries(this.tickets);
-            await fs.mkdir(path.dirname(this.dataPath), { recursive: true });
-            await fs.writeFile(this.dataPath, JSON.stringify(ticketData, null, 2));
-        } catch (error) {
-            console.error('Error saving tickets:', error);
-        }
+    getTicket(channelId) {
+        return this.tickets.get(channelId);
+    }
+
+    getGuildTickets(guildId) {
+        return Array.from(this.byGuild.get(guildId) || [], channelId => this.tickets.get(channelId));
+    }
+
+    /**
+     * Reserve the next ticket number for a guild. Synchronous, so two tickets
+     * opened at the same moment can never get the same number.
+     */
+    nextTicketNumber(guildId) {
+        return this.counters.update(guildId, (last) =>
+            // Guilds from before the counter existed continue from their ticket count
+            (last ?? (this.byGuild.get(guildId)?.size || 0)) + 1);
+    }
+
+    saveTicket(ticket) {
+        this.tickets.set(ticket.channelId, ticket);
+        this.indexTicket(ticket);
     }
 
     createTicketEmbed(guild, user, description, claimed = false, claimedBy = null) {
@@ -127,8 +145,7 @@ class TicketManager {
             }
             
             const config = ticketConfig.getGuildConfig(guild.id);
-            const ticketCount = Array.from(this.tickets.values())
-                .filter(t => t.guildId === guild.id).length + 1;
+            const ticketCount = this.nextTicketNumber(guild.id);
             const channelName = config.ticketSettings.nameFormat.replace('{number}', ticketCount);
 
             // Get the bot's member using this.client or fallback to guild.client
@@ -206,7 +223,8 @@ class TicketManager {
                 components: [buttons]
             });
 
-            this.tickets.set(ticketChannel.id, {
+            this.saveTicket({
+                number: ticketCount,
                 userId: user.id,
                 channelId: ticketChannel.id,
                 guildId: guild.id,
@@ -219,7 +237,6 @@ class TicketManager {
                 claimedBy: null
             });
 
-            await this.saveTickets();
             return ticketChannel;
         } catch (error) {
             console.error('Error creating ticket:', error);
@@ -231,8 +248,8 @@ class TicketManager {
         const ticket = this.tickets.get(channelId);
         if (!ticket || ticket.claimed) return false;
 
-        ticket.claimed = true;
-        ticket.claimedBy = staff.id;
+        // Claim before any await so a second click can't claim it too
+        this.saveTicket({ ...ticket, claimed: true, claimedBy: staff.id });
 
         const channel = await this.client.channels.fetch(channelId);
         if (!channel) return false;
@@ -251,7 +268,6 @@ class TicketManager {
         const buttons = this.createTicketButtons(true);
 
         await message.edit({ embeds: [embed], components: [buttons] });
-        await this.saveTickets();
 
         return true;
     }
@@ -262,18 +278,15 @@ class TicketManager {
             if (!ticket) return false;
 
             // Save transcript before closing
-            const transcriptPath = await this.saveTranscript(channelId);
+            const transcript = await this.saveTranscript(channelId);
 
-            if (transcriptPath) {
+            if (transcript) {
                 const guild = await this.client.guilds.fetch(ticket.guildId);
                 const config = ticketConfig.getGuildConfig(guild.id);
 
                 if (config.transcriptChannel) {
                     const transcriptChannel = await guild.channels.fetch(config.transcriptChannel);
                     if (transcriptChannel) {
-                        const transcriptContent = await fs.readFile(transcriptPath, 'utf-8');
-                        const transcriptData = JSON.parse(transcriptContent);
-
                         const transcriptEmbed = new EmbedBuilder()
                             .setColor(Colors.INFO)
                             .setTitle(`Ticket Transcript - #${ticket.channelId}`)
@@ -281,19 +294,19 @@ class TicketManager {
                             .addFields(
                                 { name: 'Reason', value: ticket.reason },
                                 { name: 'Status', value: 'Closed' },
+                                { name: 'Messages', value: String(transcript.messages), inline: true },
                                 { name: 'Created At', value: new Date(ticket.createdAt).toLocaleString() }
                             );
 
                         await transcriptChannel.send({
                             embeds: [transcriptEmbed],
-                            files: [transcriptPath]
+                            files: transcript.files
                         });
                     }
                 }
             }
 
-            ticket.status = 'closed';
-            await this.saveTickets();
+            this.saveTicket({ ...ticket, status: 'closed', closedAt: Date.now() });
             return true;
         } catch (error) {
             console.error('Error closing ticket:', error);
@@ -301,6 +314,10 @@ class TicketManager {
         }
     }
 
+    /**
+     * Export the ticket's full channel history to data/transcripts/<guildId>/.
+     * @returns {Promise<{ files: string[], messages: number }|null>}
+     */
     async saveTranscript(channelId) {
         try {
             if (!this.client) {
@@ -313,26 +330,13 @@ class TicketManager {
             const channel = await this.client.channels.fetch(channelId);
             if (!channel) return null;
 
-            const messages = await channel.messages.fetch();
-            const transcript = Array.from(messages.values())
-                .reverse()
-                .map(msg => ({
-                    author: msg.author.tag,
-                    content: msg.content,
-                    timestamp: msg.createdAt.toISOString(),
-                    attachments: Array.from(msg.attachments.values()).map(a => a.url),
-                }));
-
-            const transcriptDir = path.join(process.cwd(), 'data', 'transcripts');
-            await fs.mkdir(transcriptDir, { recursive: true });
-
-            const transcriptPath = path.join(transcriptDir, `ticket-${channelId}.json`);
-            await fs.writeFile(transcriptPath, JSON.stringify({
-                ticketInfo: ticket,
-                messages: transcript,
-            }, null, 2));
-
-            return transcriptPath;
+            const config = ticketConfig.getGuildConfig(ticket.guildId);
+            const { ndjsonPath, htmlPath, messages } = await writeTranscript(channel, ticket, {
+                dir: path.join(this.transcriptDir, ticket.guildId),
+                html: config.ticketSettings.transcriptHtml
+            });
+
+            return { files: htmlPath ? [htmlPath, ndjsonPath] : [ndjsonPath], messages };
         } catch (error) {
             console.error('Error saving transcript:', error);
             return null;
@@ -366,26 +370,28 @@ class TicketManager {
                     break;
                 }
                 case 'ticket_transcript': {
-                    const transcriptPath = await this.saveTranscript(interaction.channel.id);
-                    if (transcriptPath) {
+                    // Long tickets take several history pages; don't let the interaction expire
+                    await interaction.deferReply({ ephemeral: true });
+                    const transcript = await this.saveTranscript(interaction.channel.id);
+                    if (transcript) {
                         const guild = interaction.guild;
                         const config = ticketConfig.getGuildConfig(guild.id);
                         if (config.transcriptChannel) {
                             const transcriptChannel = await guild.channels.fetch(config.transcriptChannel);
                             if (transcriptChannel) {
                                 await transcriptChannel.send({
-                                    content: `Ticket Transcript for <#${interaction.channel.id}>`,
-                                    files: [transcriptPath]
+                                    content: `Ticket Transcript for <#${interaction.channel.id}> (${transcript.messages} messages)`,
+                                    files: transcript.files
                                 });
-                                await interaction.reply({ content: 'Transcript saved and sent.', ephemeral: true });
+                                await interaction.editReply({ content: 'Transcript saved and sent.' });
                             } else {
-                                await interaction.reply({ content: 'Transcript channel not found.', ephemeral: true });
+                                await interaction.editReply({ content: 'Transcript channel not found.' });
                             }
                         } else {
-                            await interaction.reply({ content: 'Transcript channel is not configured: do /ticket setup', ephemeral: true });
+                            await interaction.editReply({ content: 'Transcript channel is not configured: do /ticket setup' });
                         }
                     } else {
-                        await interaction.reply({ content: ';c Failed to save transcript.', ephemeral: true });
+                        await interaction.editReply({ content: ';c Failed to save transcript.' });
                     }
                     break;
                 }
@@ -398,6 +404,8 @@ class TicketManager {
             console.error('Error handling ticket button:', error);
             if (!interaction.deferred && !interaction.replied) {
                 await interaction.reply({ content: 'Prob an internal error occurred while processing this ticket action.', ephemeral: true });
+            } else if (interaction.deferred) {
+                await interaction.editReply({ content: 'Prob an internal error occurred while processing this ticket action.' }).catch(() => {});
             }
         }
     }
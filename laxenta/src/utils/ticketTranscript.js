@@ -0,0 +1,140 @@
+const fs = require('fs');
+const path = require('path');
+const zlib = require('zlib');
+const { once } = require('events');
+const { pipeline } = require('stream/promises');
+
+const PAGE_SIZE = 100; // Discord's maximum per history request
+
+/**
+ * Walk a channel's entire history, oldest first, one page at a time.
+ *
+ * Pages are requested with a snowflake cursor and bypass the message cache,
+ * so only a single page is ever held in memory however long the ticket is.
+ */
+async function* fetchHistory(channel) {
+    let cursor = '0';
+    for (;;) {
+        const page = await channel.messages.fetch({ limit: PAGE_SIZE, after: cursor, cache: false });
+        if (page.size === 0) return;
+
+        const messages = [...page.values()].sort((a, b) => a.createdTimestamp - b.createdTimestamp);
+        yield* messages;
+
+        cursor = messages[messages.length - 1].id;
+        if (page.size < PAGE_SIZE) return;
+    }
+}
+
+function toRecord(msg) {
+    return {
+        type: 'message',
+        id: msg.id,
+        author: msg.author.tag,
+        authorId: msg.author.id,
+        content: msg.content,
+        timestamp: msg.createdAt.toISOString(),
+        attachments: Array.from(msg.attachments.values()).map(a => a.url),
+        embeds: msg.embeds.length
+    };
+}
+
+function escapeHtml(text) {
+    return String(text ?? '')
+        .replace(/&/g, '&amp;')
+        .replace(/</g, '&lt;')
+        .replace(/>/g, '&gt;')
+        .replace(/"/g, '&quot;');
+}
+
+function htmlHeader(ticket, channel) {
+    return `<!DOCTYPE html>
+<html><head><meta charset="utf-8"><title>Ticket ${escapeHtml(channel.name)}</title>
+<style>
+body{background:#313338;color:#dbdee1;font-family:sans-serif;margin:0;padding:24px}
+h1{font-size:20px;margin:0 0 4px}.meta{color:#949ba4;margin-bottom:24px}
+.msg{padding:6px 0;border-bottom:1px solid #3f4147}.author{font-weight:600;color:#f2f3f5}
+.time{color:#949ba4;font-size:12px;margin-left:8px}.content{white-space:pre-wrap;margin-top:2px}
+a{color:#00a8fc}
+</style></head><body>
+<h1>#${escapeHtml(channel.name)}</h1>
+<div class="meta">Opened by ${escapeHtml(ticket.userId)} on ${new Date(ticket.createdAt).toISOString()} &middot; Reason: ${escapeHtml(ticket.reason)}</div>
+`;
+}
+
+function htmlMessage(record) {
+    const attachments = record.attachments
+        .map(url => `<div><a href="${escapeHtml(url)}">${escapeHtml(path.basename(url.split('?')[0]))}</a></div>`)
+        .join('');
+    return `<div class="msg"><span class="author">${escapeHtml(record.author)}</span>`
+        + `<span class="time">${record.timestamp}</span>`
+        + `<div class="content">${escapeHtml(record.content)}</div>${attachments}</div>\n`;
+}
+
+// Respect backpressure so a slow disk never lets pages pile up in memory.
+// `failed` rejects if the stream's destination breaks, which would otherwise
+// leave us waiting for a 'drain' that never comes.
+async function write(stream, chunk, failed) {
+    if (stream.write(chunk)) return;
+    await (failed ? Promise.race([once(stream, 'drain'), failed]) : once(stream, 'drain'));
+}
+
+async function finish(stream, fileStream) {
+    stream.end();
+    await once(fileStream, 'finish');
+}
+
+/**
+ * Stream a ticket channel's full history to `<base>.ndjson.gz`, plus an
+ * optional `<base>.html` render for reading directly in Discord.
+ *
+ * The first NDJSON line is the ticket record, followed by one line per message.
+ * @returns {Promise<{ ndjsonPath: string, htmlPath: string|null, messages: number }>}
+ */
+async function writeTranscript(channel, ticket, { dir, html = false }) {
+    await fs.promises.mkdir(dir, { recursive: true });
+    const base = path.join(dir, `ticket-${channel.id}`);
+    const ndjsonPath = `${base}.ndjson.gz`;
+    const htmlPath = html ? `${base}.html` : null;
+
+    const ndjsonFile = fs.createWriteStream(`${ndjsonPath}.tmp`);
+    const gzip = zlib.createGzip();
+    // Unlike pipe(), pipeline() surfaces file errors (e.g. ENOSPC) and tears down both streams.
+    const ndjsonDone = pipeline(gzip, ndjsonFile);
+    const ndjsonFailed = ndjsonDone.then(() => new Promise(() => {}));
+    ndjsonFailed.catch(() => {}); // observed through write() and the final await
+    const htmlFile = htmlPath ? fs.createWriteStream(`${htmlPath}.tmp`) : null;
+
+    let messages = 0;
+    try {
+        await write(gzip, JSON.stringify({ type: 'ticket', ...ticket }) + '\n', ndjsonFailed);
+        if (htmlFile) await write(htmlFile, htmlHeader(ticket, channel));
+
+        for await (const msg of fetchHistory(channel)) {
+            const record = toRecord(msg);
+            await write(gzip, JSON.stringify(record) + '\n', ndjsonFailed);
+            if (htmlFile) await write(htmlFile, htmlMessage(record));
+            messages++;
+        }
+
+        if (htmlFile) await write(htmlFile, `<div class="meta">${messages} messages</div>\n</body></html>\n`);
+        gzip.end();
+        await ndjsonDone;
+        if (htmlFile) await finish(htmlFile, htmlFile);
+    } catch (error) {
+        gzip.destroy();
+        ndjsonFile.destroy();
+        htmlFile?.destroy();
+        await fs.promises.unlink(`${ndjsonPath}.tmp`).catch(() => {});
+        if (htmlPath) await fs.promises.unlink(`${htmlPath}.tmp`).catch(() => {});
+        throw error;
+    }
+
+    // Only replace an earlier transcript once the new one is complete.
+    await fs.promises.rename(`${ndjsonPath}.tmp`, ndjsonPath);
+    if (htmlPath) await fs.promises.rename(`${htmlPath}.tmp`, htmlPath);
+
+    return { ndjsonPath, htmlPath, messages };
+}
+
+module.exports = { writeTranscript, fetchHistory };